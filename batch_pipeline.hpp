@@ -0,0 +1,218 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <format>
+#include <map>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "bounded_queue.hpp"
+#include "fixed_people_count.hpp"
+#include "instance_file.hpp"
+#include "solve_metrics.hpp"
+#include "tracing.hpp"
+
+struct instance_chunk_type {
+  std::size_t chunk_index;
+  //  instance i is times[instance_offsets[i], instance_offsets[i + 1])
+  std::vector<time_to_cross_type> times;
+  std::vector<std::size_t> instance_offsets;
+  std::vector<fixed_schedule_type> schedules;
+  std::string output;
+};
+
+struct batch_pipeline_options_type {
+  std::size_t solver_count;
+  std::size_t chunk_instance_count;
+  //  chunks allocated in total, which bounds memory whatever the input size
+  std::size_t chunk_count;
+  //  receives the solve latencies once per chunk, unless nullptr
+  solve_metrics_collector_type *metrics;
+};
+
+//  one line per instance: the optimal total time, then the crosser mask of every crossing
+inline void format_schedule(fixed_schedule_type const &schedule, std::string &output) {
+  std::array<char, 16> buffer;
+
+  auto const append = [&](auto const value) {
+    auto const [end, error] = std::to_chars(buffer.data(), buffer.data() + buffer.size(), value);
+    output.append(buffer.data(), end);
+  };
+
+  append(schedule.total_time);
+  for (std::size_t step_index = 1; step_index < schedule.state_reprs.size(); ++step_index) {
+    output.push_back(' ');
+    append((schedule.state_reprs.at(step_index - 1) ^ schedule.state_reprs.at(step_index)) >> 1);
+  }
+  output.push_back('\n');
+}
+
+//  solves every instance of input with solve_fixed and passes the formatted schedules to
+//  write_output(std::string_view) in input order, in three stages connected by bounded_queue_type:
+//    reading: one thread parses chunks of instances from input
+//    solving: solver_count threads solve whole chunks
+//    writing: one thread formats the chunks and writes them in chunk order
+//  chunks are taken from a fixed pool and returned to it once written, so reading waits for writing
+//  once chunk_count chunks are in flight. chunks finished out of order wait in the writer until their
+//  turn, so the output does not depend on the scheduling. the first exception of any stage cancels the
+//  others and is rethrown.
+template <typename write_output_type>
+void run_batch_pipeline(
+  instance_stream_type &input,
+  write_output_type &&write_output,
+  batch_pipeline_options_type const &options
+) {
+  if (options.solver_count == 0 || options.chunk_instance_count == 0 || options.chunk_count == 0) {
+    throw std::invalid_argument(std::format(
+      "options are out of range. are {}, {} and {}. should all be positive.",
+      options.solver_count, options.chunk_instance_count, options.chunk_count
+    ));
+  }
+
+  std::vector<instance_chunk_type> chunks(options.chunk_count);
+  //  nullptr marks the end of the stream
+  bounded_queue_type<instance_chunk_type *> free_chunks {options.chunk_count};
+  bounded_queue_type<instance_chunk_type *> read_chunks {options.chunk_count + options.solver_count};
+  bounded_queue_type<instance_chunk_type *> solved_chunks {options.chunk_count + options.solver_count};
+
+  std::atomic<bool> cancelled = false;
+  std::exception_ptr first_exception;
+  std::mutex first_exception_mutex;
+
+  auto const run_stage = [&](auto const &stage) {
+    try {
+      stage();
+    } catch (...) {
+      std::scoped_lock const lock {first_exception_mutex};
+      if (!first_exception) {
+        first_exception = std::current_exception();
+      }
+      cancelled.store(true);
+    }
+  };
+
+  for (auto &chunk : chunks) {
+    auto chunk_pointer = &chunk;
+    free_chunks.try_push(chunk_pointer);
+  }
+
+  {
+    std::vector<std::jthread> threads;
+
+    threads.emplace_back([&] {
+      run_stage([&] {
+        for (std::size_t chunk_index = 0;; ++chunk_index) {
+          instance_chunk_type *chunk;
+          if (!free_chunks.pop(chunk, cancelled)) {
+            return;
+          }
+          if (!input.read_chunk(options.chunk_instance_count, chunk->times, chunk->instance_offsets)) {
+            break;
+          }
+          chunk->chunk_index = chunk_index;
+          if (!read_chunks.push(chunk, cancelled)) {
+            return;
+          }
+        }
+
+        for (std::size_t solver_index = 0; solver_index < options.solver_count; ++solver_index) {
+          instance_chunk_type *end_of_stream = nullptr;
+          if (!read_chunks.push(end_of_stream, cancelled)) {
+            return;
+          }
+        }
+      });
+    });
+
+    for (std::size_t solver_index = 0; solver_index < options.solver_count; ++solver_index) {
+      threads.emplace_back([&] {
+        run_stage([&] {
+          instance_chunk_type *chunk;
+          solve_metrics_type chunk_metrics;
+
+          while (read_chunks.pop(chunk, cancelled)) {
+            if (chunk != nullptr) {
+              ROPE_BRIDGE_TRACE_SPAN_ARG("solve_chunk", chunk->chunk_index);
+              auto const instance_count = chunk->instance_offsets.size() - 1;
+              chunk->schedules.clear();
+              for (std::size_t instance_index = 0; instance_index < instance_count; ++instance_index) {
+                auto const offset = chunk->instance_offsets.at(instance_index);
+                auto const times_to_cross = std::span {chunk->times}.subspan(
+                  offset, chunk->instance_offsets.at(instance_index + 1) - offset
+                );
+
+                if (options.metrics == nullptr) {
+                  chunk->schedules.push_back(solve_fixed(times_to_cross));
+                  continue;
+                }
+                auto const solve_start = std::chrono::steady_clock::now();
+                chunk->schedules.push_back(solve_fixed(times_to_cross));
+                chunk_metrics.record(times_to_cross.size(), get_elapsed_ns(solve_start));
+              }
+
+              if (options.metrics != nullptr) {
+                options.metrics->add(chunk_metrics);
+                chunk_metrics.clear();
+              }
+            }
+
+            if (!solved_chunks.push(chunk, cancelled) || chunk == nullptr) {
+              return;
+            }
+          }
+        });
+      });
+    }
+
+    threads.emplace_back([&] {
+      run_stage([&] {
+        std::map<std::size_t, instance_chunk_type *> waiting_chunks;
+        std::size_t next_chunk_index = 0;
+        std::size_t finished_solver_count = 0;
+        instance_chunk_type *chunk;
+
+        while (finished_solver_count < options.solver_count && solved_chunks.pop(chunk, cancelled)) {
+          if (chunk == nullptr) {
+            ++finished_solver_count;
+            continue;
+          }
+          waiting_chunks.emplace(chunk->chunk_index, chunk);
+
+          for (
+            auto next_chunk = waiting_chunks.find(next_chunk_index);
+            next_chunk != waiting_chunks.end();
+            next_chunk = waiting_chunks.find(++next_chunk_index)
+          ) {
+            auto written_chunk = next_chunk->second;
+            waiting_chunks.erase(next_chunk);
+            ROPE_BRIDGE_TRACE_SPAN_ARG("write_chunk", written_chunk->chunk_index);
+
+            written_chunk->output.clear();
+            for (auto const &schedule : written_chunk->schedules) {
+              format_schedule(schedule, written_chunk->output);
+            }
+            write_output(std::string_view {written_chunk->output});
+
+            if (!free_chunks.push(written_chunk, cancelled)) {
+              return;
+            }
+          }
+        }
+      });
+    });
+  }
+
+  if (first_exception) {
+    std::rethrow_exception(first_exception);
+  }
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <utility>
+
+//  a bounded lock-free queue for any number of producers and consumers (Vyukov's array queue). every
+//  cell carries a sequence number that tells a producer when the cell is free and a consumer when it
+//  is filled, so each side claims a position with one compare and exchange and never waits on a lock.
+//  the capacity is rounded up to a power of two.
+template <typename value_type>
+struct bounded_queue_type {
+  explicit bounded_queue_type(std::size_t const min_capacity)
+    : cells {std::make_unique<cell_type[]>(std::bit_ceil(std::max(min_capacity, std::size_t {2})))},
+      position_mask {std::bit_ceil(std::max(min_capacity, std::size_t {2})) - 1} {
+    for (std::size_t position = 0; position <= position_mask; ++position) {
+      cells[position].sequence.store(position, std::memory_order_relaxed);
+    }
+  }
+
+  //  leaves value untouched when the queue is full
+  bool try_push(value_type &value) {
+    auto position = push_position.load(std::memory_order_relaxed);
+
+    while (true) {
+      auto &cell = cells[position & position_mask];
+      auto const sequence = cell.sequence.load(std::memory_order_acquire);
+      auto const difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+
+      if (difference == 0) {
+        if (push_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+          cell.value = std::move(value);
+          cell.sequence.store(position + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (difference < 0) {
+        return false;
+      } else {
+        position = push_position.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  bool try_pop(value_type &value) {
+    auto position = pop_position.load(std::memory_order_relaxed);
+
+    while (true) {
+      auto &cell = cells[position & position_mask];
+      auto const sequence = cell.sequence.load(std::memory_order_acquire);
+      auto const difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position + 1);
+
+      if (difference == 0) {
+        if (pop_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+          value = std::move(cell.value);
+          cell.sequence.store(position + position_mask + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (difference < 0) {
+        return false;
+      } else {
+        position = pop_position.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  //  the blocking forms back off from spinning to yielding to short sleeps, and give up once cancelled is
+  //  set, returning false
+  bool push(value_type &value, std::atomic<bool> const &cancelled) {
+    return wait_until([&] { return try_push(value); }, cancelled);
+  }
+
+  bool pop(value_type &value, std::atomic<bool> const &cancelled) {
+    return wait_until([&] { return try_pop(value); }, cancelled);
+  }
+
+  private:
+  struct cell_type {
+    std::atomic<std::size_t> sequence;
+    value_type value;
+  };
+
+  template <typename attempt_type>
+  static bool wait_until(attempt_type const &attempt, std::atomic<bool> const &cancelled) {
+    for (std::size_t attempt_count = 0; !attempt(); ++attempt_count) {
+      if (cancelled.load(std::memory_order_relaxed)) {
+        return false;
+      }
+      if (attempt_count < 64) {
+        continue;
+      }
+      if (attempt_count < 128) {
+        std::this_thread::yield();
+      } else {
+        std::this_thread::sleep_for(std::chrono::microseconds {50});
+      }
+    }
+    return true;
+  }
+
+  //  keeps producers and consumers from sharing a cache line on common targets, without the ABI
+  //  concerns of std::hardware_destructive_interference_size
+  static auto constexpr cache_line_size = std::size_t {64};
+
+  std::unique_ptr<cell_type[]> cells;
+  std::size_t position_mask;
+  alignas(cache_line_size) std::atomic<std::size_t> push_position = 0;
+  alignas(cache_line_size) std::atomic<std::size_t> pop_position = 0;
+};
@@ -0,0 +1,279 @@
+#pragma once
+
+#include <cassert>
+#include <climits>
+#include <cstddef>
+#include <expected>
+#include <format>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "memory_tracking.hpp"
+
+using time_to_cross_type = int;
+
+//  how the factories of bridge_state_type check their arguments.
+//  full: throw std::invalid_argument. debug_assert: assert, so nothing is left with NDEBUG.
+//  unchecked: nothing, for callers whose arguments are valid by construction.
+enum class bridge_state_checking_type {
+  full,
+  debug_assert,
+  unchecked
+};
+
+//  for loops over crossers taken from get_possible_crosser_indices. a release build leaves the pure XOR,
+//  and defining ROPE_BRIDGE_FULL_CHECKING keeps the full checks there for verification builds.
+#ifdef ROPE_BRIDGE_FULL_CHECKING
+inline auto constexpr hot_path_bridge_state_checking = bridge_state_checking_type::full;
+#else
+inline auto constexpr hot_path_bridge_state_checking = bridge_state_checking_type::debug_assert;
+#endif
+
+//  why the arguments of a bridge_state_type factory are invalid. the message is only formatted on request.
+struct bridge_state_error_type {
+  enum class kind_type {
+    people_count_out_of_range,
+    crosser_index_out_of_range,
+    crosser_indices_not_distinct
+  };
+
+  kind_type kind;
+  std::size_t value;
+  std::size_t min_value;
+  std::size_t max_value;
+
+  [[nodiscard]] std::string get_message() const {
+    switch (kind) {
+      case kind_type::people_count_out_of_range:
+        return std::format(
+          "people_count is out of range. is {}. should be in range [{}, {}].",
+          value, min_value, max_value
+        );
+      case kind_type::crosser_index_out_of_range:
+        return std::format(
+          "crosser_index is out of range. is {}. should be in range [{}, {}].",
+          value, min_value, max_value
+        );
+      case kind_type::crosser_indices_not_distinct:
+        return std::format(
+          "first and second crosser indices are out of range. both are {}. should be distinct.",
+          value
+        );
+    }
+    return {};
+  }
+};
+
+struct bridge_state_type {
+  template <bridge_state_checking_type checking = bridge_state_checking_type::full>
+  static bridge_state_type start(std::size_t const people_count) {
+    check<checking>([&] { return get_people_count_error(people_count); });
+    return {.state_repr = one_as_int_value_type << (people_count + 1)};
+  }
+
+  template <bridge_state_checking_type checking = bridge_state_checking_type::full>
+  static bridge_state_type end(std::size_t const people_count) {
+    check<checking>([&] { return get_people_count_error(people_count); });
+    return {.state_repr = (one_as_int_value_type << (people_count + 2)) - 1};
+  }
+
+  template <bridge_state_checking_type checking = bridge_state_checking_type::full>
+  static bridge_state_type after_single_crossing(
+    bridge_state_type const &prior_state,
+    std::size_t const crosser_index
+  ) {
+    check<checking>([&] { return get_crosser_index_error(prior_state.state_repr, crosser_index); });
+    return {
+      .state_repr = prior_state.state_repr
+        ^ torch_bit
+        ^ 1 << crosser_index + 1
+    };
+  }
+
+  template <bridge_state_checking_type checking = bridge_state_checking_type::full>
+  static bridge_state_type after_double_crossing(
+    bridge_state_type const &prior_state,
+    std::size_t const first_crosser_index,
+    std::size_t const second_crosser_index
+    ) {
+    check<checking>([&] {
+      return get_crosser_indices_error(prior_state.state_repr, first_crosser_index, second_crosser_index);
+    });
+    return {
+      .state_repr = prior_state.state_repr
+        ^ torch_bit
+        ^ 1 << first_crosser_index + 1
+        ^ 1 << second_crosser_index + 1
+    };
+  }
+
+  //  the same factories returning the error instead of throwing, for API boundaries
+  static std::expected<bridge_state_type, bridge_state_error_type> try_start(std::size_t const people_count) {
+    if (auto const error = get_people_count_error(people_count)) {
+      return std::unexpected(*error);
+    }
+    return start<bridge_state_checking_type::unchecked>(people_count);
+  }
+
+  static std::expected<bridge_state_type, bridge_state_error_type> try_end(std::size_t const people_count) {
+    if (auto const error = get_people_count_error(people_count)) {
+      return std::unexpected(*error);
+    }
+    return end<bridge_state_checking_type::unchecked>(people_count);
+  }
+
+  static std::expected<bridge_state_type, bridge_state_error_type> try_after_single_crossing(
+    bridge_state_type const &prior_state,
+    std::size_t const crosser_index
+  ) {
+    if (auto const error = get_crosser_index_error(prior_state.state_repr, crosser_index)) {
+      return std::unexpected(*error);
+    }
+    return after_single_crossing<bridge_state_checking_type::unchecked>(prior_state, crosser_index);
+  }
+
+  static std::expected<bridge_state_type, bridge_state_error_type> try_after_double_crossing(
+    bridge_state_type const &prior_state,
+    std::size_t const first_crosser_index,
+    std::size_t const second_crosser_index
+  ) {
+    if (auto const error = get_crosser_indices_error(prior_state.state_repr, first_crosser_index, second_crosser_index)) {
+      return std::unexpected(*error);
+    }
+    return after_double_crossing<bridge_state_checking_type::unchecked>(
+      prior_state, first_crosser_index, second_crosser_index
+    );
+  }
+
+  using int_value_type = unsigned int;
+  static auto constexpr int_value_type_bit_count = sizeof(int_value_type) * CHAR_BIT;
+
+  [[nodiscard]] int_value_type get_possible_crosser_indices() const {
+    auto const torch_crossed = get_torch_crossed();
+    auto result = state_repr >> 1;
+    auto const people_mask = get_leading_one(result) - 1;
+    result &= people_mask;
+    if (!torch_crossed) {
+      result ^= people_mask;
+    }
+
+    return result;
+  }
+
+  [[nodiscard]] bool get_torch_crossed() const {
+    return (state_repr & 1) == 1;
+  }
+
+  [[nodiscard]] std::size_t get_people_count() const {
+    return get_leading_one_pos(state_repr) - 1;
+  }
+
+  static auto constexpr min_people = 1;
+  static auto constexpr max_people = int_value_type_bit_count - 2;
+
+  //  state_repr has the bitwise form 00…001pp…ppt
+  //  unused bits are on the high end and have the form 00..001 or in a special case just a leading 1
+  //  p bits represent whether a given person has crossed the bridge, 0: before the bridge, 1: after
+  //    the expected index of a given person is offset by 1 due to the torch bit
+  //  the t bit represents the side of the torch
+  int_value_type state_repr;
+
+  struct crossing_type {
+    std::size_t state_index_after_crossing;
+    time_to_cross_type time_to_cross;
+  };
+  tracked_vector_type<crossing_type, memory_category_type::possible_crossings> possible_crossings;
+
+  private:
+  template <bridge_state_checking_type checking, typename get_error_type>
+  static void check(get_error_type const &get_error) {
+    if constexpr (checking == bridge_state_checking_type::full) {
+      if (auto const error = get_error()) {
+        throw std::invalid_argument(error->get_message());
+      }
+    } else if constexpr (checking == bridge_state_checking_type::debug_assert) {
+      assert(!get_error().has_value());
+    }
+  }
+
+  static std::optional<bridge_state_error_type> get_people_count_error(std::size_t const people_count) {
+    if (people_count < min_people || people_count > max_people) {
+      return bridge_state_error_type {
+        .kind = bridge_state_error_type::kind_type::people_count_out_of_range,
+        .value = people_count,
+        .min_value = min_people,
+        .max_value = max_people
+      };
+    }
+    return std::nullopt;
+  }
+
+  static std::optional<bridge_state_error_type> get_crosser_index_error(
+    int_value_type const state_repr,
+    std::size_t const crosser_index
+  ) {
+    if (
+      auto const leading_one_pos = get_leading_one_pos(state_repr);
+      crosser_index >= leading_one_pos - 1
+    ) {
+      return bridge_state_error_type {
+        .kind = bridge_state_error_type::kind_type::crosser_index_out_of_range,
+        .value = crosser_index,
+        .min_value = 0,
+        .max_value = leading_one_pos - 1
+      };
+    }
+    return std::nullopt;
+  }
+
+  static std::optional<bridge_state_error_type> get_crosser_indices_error(
+    int_value_type const state_repr,
+    std::size_t const first_crosser_index,
+    std::size_t const second_crosser_index
+  ) {
+    if (auto const error = get_crosser_index_error(state_repr, first_crosser_index)) {
+      return error;
+    }
+    if (auto const error = get_crosser_index_error(state_repr, second_crosser_index)) {
+      return error;
+    }
+    if (first_crosser_index == second_crosser_index) {
+      return bridge_state_error_type {
+        .kind = bridge_state_error_type::kind_type::crosser_indices_not_distinct,
+        .value = first_crosser_index,
+        .min_value = 0,
+        .max_value = 0
+      };
+    }
+    return std::nullopt;
+  }
+
+  static int_value_type get_leading_one(int_value_type const state_repr) {
+    return one_as_int_value_type << get_leading_one_pos(state_repr);
+  }
+
+  static std::size_t get_leading_one_pos(int_value_type const state_repr) {
+    return int_value_type_bit_count - 1 - __builtin_clz(state_repr);
+  }
+
+  static auto constexpr one_as_int_value_type = static_cast<int_value_type>(1);
+  static auto constexpr torch_bit = one_as_int_value_type;
+
+  friend std::string as_bits(bridge_state_type const &state);
+};
+
+inline std::string as_bits(bridge_state_type const &state) {
+  auto const leading_one_pos = bridge_state_type::get_leading_one_pos(state.state_repr);
+
+  std::ostringstream result;
+  for (auto bit = bridge_state_type::one_as_int_value_type << leading_one_pos - 1; bit != 1; bit >>= 1) {
+    result << (state.state_repr & bit? "1" : "0");
+  }
+  result << " ";
+  result << (state.state_repr & 1? "1" : "0");
+
+  return result.str();
+}
@@ -0,0 +1,298 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <queue>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "bridge_state.hpp"
+#include "csr_state_graph.hpp"
+#include "fixed_people_count.hpp"
+#include "memory_tracking.hpp"
+#include "shortest_path.hpp"
+#include "solver_observer.hpp"
+#include "state_graph.hpp"
+#include "tracing.hpp"
+
+//  from the most to the least stored, which build_budgeted_state_graph tries in turn
+enum class state_graph_representation_type {
+  //  states_list_type from build_fixed_state_graph, what the analyses take
+  adjacency_lists,
+  //  csr_state_graph_type with the times of the crossings
+  csr,
+  //  csr_state_graph_type weighing crossings by their crossers
+  compact_csr,
+  //  compact_csr in a file mapping, paged in and out by the kernel
+  external_csr,
+  //  no graph; solving generates the crossings of every expanded state as solve_fixed does
+  implicit
+};
+
+inline std::string_view get_state_graph_representation_name(state_graph_representation_type const representation) {
+  static constexpr std::array<std::string_view, 5> names {
+    "adjacency_lists", "csr", "compact_csr", "external_csr", "implicit"
+  };
+  return names.at(static_cast<std::size_t>(representation));
+}
+
+struct state_graph_budget_type {
+  std::uint64_t memory_bytes;
+  //  where external_csr may create its file, which must not exist yet, or empty to keep to memory
+  std::string external_path;
+};
+
+//  bytes held in memory for people_count people at the peak of building the graph and solving over it,
+//  adding the builder's tables to the graph rather than assuming they are freed in time. the graph of
+//  external_csr is left out, being in pages the kernel can write out.
+inline std::uint64_t get_estimated_representation_bytes(
+  state_graph_representation_type const representation,
+  std::size_t const people_count
+) {
+  auto const state_count = csr_state_graph_type::get_state_count(people_count);
+  auto const crossing_count = csr_state_graph_type::get_crossing_count(people_count);
+  auto const table_size = state_count + 2;
+
+  //  distances, predecessors and a frontier of as many labels
+  auto const get_scratch_bytes = [&](std::size_t const state_index_bytes) {
+    return state_count * (sizeof(time_to_cross_type) + state_index_bytes) * 2;
+  };
+  auto const csr_table_bytes = table_size * sizeof(csr_state_graph_type::state_index_type);
+  auto const csr_scratch_bytes = get_scratch_bytes(sizeof(csr_state_graph_type::state_index_type));
+
+  switch (representation) {
+    case state_graph_representation_type::adjacency_lists:
+      //  growing the crossing vectors leaves about half as much again unused
+      return table_size * sizeof(std::size_t)
+        + state_count * sizeof(bridge_state_type)
+        + crossing_count * sizeof(bridge_state_type::crossing_type) * 3 / 2
+        + get_scratch_bytes(sizeof(std::size_t));
+    case state_graph_representation_type::csr:
+      return csr_table_bytes + csr_state_graph_type::get_byte_count(people_count, true) + csr_scratch_bytes;
+    case state_graph_representation_type::compact_csr:
+      return csr_table_bytes + csr_state_graph_type::get_byte_count(people_count, false) + csr_scratch_bytes;
+    case state_graph_representation_type::external_csr:
+      return csr_table_bytes + csr_scratch_bytes;
+    case state_graph_representation_type::implicit:
+      return table_size * (sizeof(time_to_cross_type) + sizeof(bridge_state_type::int_value_type))
+        + state_count * (sizeof(time_to_cross_type) + sizeof(bridge_state_type::int_value_type));
+  }
+  return std::numeric_limits<std::uint64_t>::max();
+}
+
+struct state_graph_plan_type {
+  state_graph_representation_type representation;
+  std::uint64_t estimated_bytes;
+  //  size of the mapped file, 0 unless external_csr
+  std::uint64_t external_bytes;
+};
+
+//  the most stored representation within budget. external_csr also needs an external_path on a file
+//  system with room for the whole compact graph.
+inline state_graph_plan_type plan_state_graph(std::size_t const people_count, state_graph_budget_type const &budget) {
+  //  validates the people count
+  static_cast<void>(bridge_state_type::start(people_count));
+
+  auto const get_free_external_bytes = [&] {
+    if (budget.external_path.empty()) {
+      return std::uintmax_t {0};
+    }
+    auto const directory = std::filesystem::absolute(budget.external_path).parent_path();
+    std::error_code error;
+    auto const space = std::filesystem::space(directory, error);
+    return error ? std::uintmax_t {0} : space.available;
+  };
+
+  for (auto const representation : {
+    state_graph_representation_type::adjacency_lists,
+    state_graph_representation_type::csr,
+    state_graph_representation_type::compact_csr,
+    state_graph_representation_type::external_csr,
+    state_graph_representation_type::implicit
+  }) {
+    state_graph_plan_type plan {
+      .representation = representation,
+      .estimated_bytes = get_estimated_representation_bytes(representation, people_count),
+      .external_bytes = 0
+    };
+    if (representation == state_graph_representation_type::external_csr) {
+      plan.external_bytes = csr_state_graph_type::get_byte_count(people_count, false);
+      if (plan.external_bytes > get_free_external_bytes()) {
+        continue;
+      }
+    }
+    if (plan.estimated_bytes <= budget.memory_bytes) {
+      return plan;
+    }
+  }
+
+  throw std::invalid_argument(std::format(
+    "people_count is out of range. is {}. should fit a search in {} bytes.", people_count, budget.memory_bytes
+  ));
+}
+
+//  Dijkstra over a csr_state_graph_type, as run_dijkstra over states_list_type. observer is called as
+//  in solver_observer.hpp.
+template <typename observer_type = null_solver_observer_type>
+fixed_schedule_type solve_csr_state_graph(
+  csr_state_graph_type const &graph,
+  std::span<time_to_cross_type const> const times_to_cross,
+  observer_type &&observer = {}
+) {
+  ROPE_BRIDGE_TRACE_SPAN_ARG("solve_csr_state_graph", graph.get_state_count());
+  using state_index_type = csr_state_graph_type::state_index_type;
+
+  auto constexpr unreached = std::numeric_limits<time_to_cross_type>::max();
+  tracked_vector_type<time_to_cross_type, memory_category_type::solver_scratch> distances(
+    graph.get_state_count(), unreached
+  );
+  tracked_vector_type<state_index_type, memory_category_type::solver_scratch> predecessors(
+    graph.get_state_count(), static_cast<state_index_type>(start_state_index)
+  );
+
+  struct label_type {
+    time_to_cross_type distance;
+    state_index_type state_index;
+
+    bool operator>(label_type const &other) const {
+      return distance > other.distance;
+    }
+  };
+  std::priority_queue<
+    label_type, tracked_vector_type<label_type, memory_category_type::solver_scratch>, std::greater<>
+  > frontier;
+
+  distances[start_state_index] = 0;
+  frontier.push({.distance = 0, .state_index = static_cast<state_index_type>(start_state_index)});
+
+  while (!frontier.empty()) {
+    auto const label = frontier.top();
+    frontier.pop();
+
+    if (label.distance > distances[label.state_index]) {
+      continue;
+    }
+    auto const state_repr = graph.state_reprs[label.state_index];
+    if (label.state_index == end_state_index) {
+      observer.on_goal(state_repr, label.distance);
+      break;
+    }
+    observer.on_pop(state_repr, label.distance, frontier.size());
+
+    for (
+      auto crossing_position = graph.crossing_offsets[label.state_index];
+      crossing_position < graph.crossing_offsets[label.state_index + 1];
+      ++crossing_position
+    ) {
+      auto const crossed_state_index = graph.crossing_state_indices[crossing_position];
+      auto const distance = label.distance + graph.get_time_to_cross(label.state_index, crossing_position, times_to_cross);
+      observer.on_relax(state_repr, graph.state_reprs[crossed_state_index], distance);
+      if (distance >= distances[crossed_state_index]) {
+        continue;
+      }
+      observer.on_improve(state_repr, graph.state_reprs[crossed_state_index], distance);
+      distances[crossed_state_index] = distance;
+      predecessors[crossed_state_index] = label.state_index;
+      frontier.push({.distance = distance, .state_index = crossed_state_index});
+    }
+  }
+
+  fixed_schedule_type result {
+    .total_time = distances[end_state_index],
+    .state_reprs = {graph.state_reprs[end_state_index]}
+  };
+  for (auto state_index = std::size_t {end_state_index}; state_index != start_state_index;) {
+    state_index = predecessors[state_index];
+    result.state_reprs.push_back(graph.state_reprs[state_index]);
+  }
+  std::ranges::reverse(result.state_reprs);
+
+  return result;
+}
+
+//  the state graph of one instance in the representation its plan chose
+struct budgeted_state_graph_type {
+  state_graph_plan_type plan;
+  std::vector<time_to_cross_type> times_to_cross;
+  //  only for adjacency_lists
+  states_list_type states;
+  //  only for csr, compact_csr and external_csr
+  std::optional<csr_state_graph_type> csr_graph;
+
+  [[nodiscard]] fixed_schedule_type solve() const {
+    return solve(null_solver_observer_type {});
+  }
+
+  //  solve, calling observer as in solver_observer.hpp
+  template <typename observer_type>
+  fixed_schedule_type solve(observer_type &&observer) const {
+    switch (plan.representation) {
+      case state_graph_representation_type::adjacency_lists: {
+        auto const path = solve_shortest_path(states, get_static_crossing_cost, std::forward<observer_type>(observer));
+        fixed_schedule_type result {.total_time = path.total_time, .state_reprs = {}};
+        for (auto const state_index : path.state_indices) {
+          result.state_reprs.push_back(states.at(state_index).state_repr);
+        }
+        return result;
+      }
+      case state_graph_representation_type::csr:
+      case state_graph_representation_type::compact_csr:
+      case state_graph_representation_type::external_csr:
+        return solve_csr_state_graph(*csr_graph, times_to_cross, std::forward<observer_type>(observer));
+      case state_graph_representation_type::implicit:
+        return solve_fixed(times_to_cross, observer);
+    }
+    throw std::logic_error("unknown state graph representation");
+  }
+};
+
+//  the graph of times_to_cross in the representation plan_state_graph picks for budget, instead of
+//  reserving every state and growing every crossing vector regardless of what fits
+inline budgeted_state_graph_type build_budgeted_state_graph(
+  std::span<time_to_cross_type const> const times_to_cross,
+  state_graph_budget_type const &budget
+) {
+  ROPE_BRIDGE_TRACE_SPAN_ARG("build_budgeted_state_graph", times_to_cross.size());
+  auto const people_count = times_to_cross.size();
+
+  budgeted_state_graph_type result {
+    .plan = plan_state_graph(people_count, budget),
+    .times_to_cross = {times_to_cross.begin(), times_to_cross.end()},
+    .states = {},
+    .csr_graph = std::nullopt
+  };
+
+  switch (result.plan.representation) {
+    case state_graph_representation_type::adjacency_lists:
+      result.states = build_fixed_state_graph(times_to_cross);
+      break;
+    case state_graph_representation_type::csr:
+      result.csr_graph.emplace(csr_state_graph_type::allocate(people_count, true));
+      break;
+    case state_graph_representation_type::compact_csr:
+      result.csr_graph.emplace(csr_state_graph_type::allocate(people_count, false));
+      break;
+    case state_graph_representation_type::external_csr:
+      result.csr_graph.emplace(csr_state_graph_type::map(budget.external_path, people_count, false));
+      break;
+    case state_graph_representation_type::implicit:
+      break;
+  }
+  if (result.csr_graph) {
+    fill_fixed_csr_state_graph(times_to_cross, *result.csr_graph);
+  }
+
+  return result;
+}
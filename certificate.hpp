@@ -0,0 +1,121 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "bridge_state.hpp"
+#include "shortest_path.hpp"
+#include "state_graph.hpp"
+
+//  a proof that a schedule is optimal. potentials holds a label per state of the graph with the start
+//  state at 0. no crossing is shorter than the difference of its potentials, so every schedule takes at
+//  least the potential of the end state, and the schedule's crossings all take exactly that difference,
+//  so it takes exactly that.
+struct optimality_certificate_type {
+  time_to_cross_type total_time;
+  //  from start_state_index to end_state_index
+  std::vector<std::size_t> state_indices;
+  std::vector<time_to_cross_type> potentials;
+};
+
+//  the optimal schedule with the distances of every state from the start as its potentials, from one
+//  Dijkstra run over every state whose predecessors give the schedule
+inline optimality_certificate_type make_optimality_certificate(states_list_type const &states) {
+  optimality_certificate_type result {.total_time = 0, .state_indices = {end_state_index}, .potentials = {}};
+  std::vector<std::size_t> predecessors;
+  run_dijkstra(states, start_state_index, states.size(), get_static_crossing_cost, result.potentials, predecessors);
+
+  result.total_time = result.potentials.at(end_state_index);
+  for (auto state_index = end_state_index; state_index != start_state_index;) {
+    state_index = predecessors.at(state_index);
+    result.state_indices.push_back(state_index);
+  }
+  std::ranges::reverse(result.state_indices);
+
+  return result;
+}
+
+//  checks a certificate against a graph from build_state_graph in one pass over its states and one over
+//  the schedule, without searching. returns why it does not hold, or nothing when it does. the
+//  certificate is not trusted, so differences are taken in 64 bits.
+inline std::optional<std::string> verify_optimality_certificate(
+  states_list_type const &states,
+  optimality_certificate_type const &certificate
+) {
+  auto const &potentials = certificate.potentials;
+
+  if (potentials.size() != states.size()) {
+    return std::format("potentials size is out of range. is {}. should be {}.", potentials.size(), states.size());
+  }
+  if (potentials.at(start_state_index) != 0) {
+    return std::format("potential of the start state is out of range. is {}. should be 0.", potentials.at(start_state_index));
+  }
+
+  for (std::size_t state_index = 0; state_index < states.size(); ++state_index) {
+    std::int64_t const potential = potentials.at(state_index);
+
+    for (auto const &crossing : states.at(state_index).possible_crossings) {
+      auto const reduced_time_to_cross = potential + crossing.time_to_cross - potentials.at(crossing.state_index_after_crossing);
+      if (reduced_time_to_cross < 0) {
+        return std::format(
+          "reduced time to cross from state {} to state {} is out of range. is {}. should be non-negative.",
+          state_index, crossing.state_index_after_crossing, reduced_time_to_cross
+        );
+      }
+    }
+  }
+
+  auto const &state_indices = certificate.state_indices;
+
+  if (state_indices.empty() || state_indices.front() != start_state_index || state_indices.back() != end_state_index) {
+    return std::string {"schedule is out of range. should lead from the start state to the end state."};
+  }
+
+  std::int64_t total_time = 0;
+
+  for (std::size_t step_index = 1; step_index < state_indices.size(); ++step_index) {
+    auto const curr_state_index = state_indices.at(step_index - 1);
+    auto const next_state_index = state_indices.at(step_index);
+
+    if (curr_state_index >= states.size() || next_state_index >= states.size()) {
+      return std::format(
+        "state index of step {} is out of range. is {}. should be less than {}.",
+        step_index, std::max(curr_state_index, next_state_index), states.size()
+      );
+    }
+
+    auto const &possible_crossings = states.at(curr_state_index).possible_crossings;
+    auto const crossing = std::ranges::find(
+      possible_crossings, next_state_index, &bridge_state_type::crossing_type::state_index_after_crossing
+    );
+    if (crossing == possible_crossings.end()) {
+      return std::format(
+        "step {} from state {} to state {} is out of range. should be a possible crossing.",
+        step_index, curr_state_index, next_state_index
+      );
+    }
+
+    std::int64_t const potential_difference = potentials.at(next_state_index) - std::int64_t {potentials.at(curr_state_index)};
+    if (crossing->time_to_cross != potential_difference) {
+      return std::format(
+        "time to cross of step {} is out of range. is {}. should be the potential difference {}.",
+        step_index, crossing->time_to_cross, potential_difference
+      );
+    }
+    total_time += crossing->time_to_cross;
+  }
+
+  if (total_time != certificate.total_time || total_time != potentials.at(end_state_index)) {
+    return std::format(
+      "total time is out of range. is {}. should be {} as both the schedule length and the end state potential.",
+      certificate.total_time, total_time
+    );
+  }
+
+  return std::nullopt;
+}
@@ -0,0 +1,387 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "bridge_state.hpp"
+#include "fixed_people_count.hpp"
+#include "memory_tracking.hpp"
+#include "solver_observer.hpp"
+#include "tracing.hpp"
+
+//  a state reached by solve_checkpointed, as its checkpoints store it
+struct search_checkpoint_reached_state_type {
+  bridge_state_type::int_value_type state_offset;
+  time_to_cross_type distance;
+  bridge_state_type::int_value_type predecessor_offset;
+};
+
+//  a checkpoint of solve_checkpointed is this header, native-endian like the binary instance format,
+//  followed by 32-bit words: the times to cross, reached_count search_checkpoint_reached_state_type
+//  in state_repr order, then frontier_size labels of a distance and a state_repr offset each. states
+//  not reached are left out, so a checkpoint grows with the search rather than with 2^people_count.
+struct search_checkpoint_header_type {
+  static auto constexpr checkpoint_magic = std::uint64_t {0x32'54'50'4b'43'45'48'43ull};
+  static auto constexpr label_byte_count = sizeof(time_to_cross_type) + sizeof(bridge_state_type::int_value_type);
+
+  std::uint64_t magic;
+  std::uint64_t people_count;
+  //  labels expanded so far
+  std::uint64_t pop_count;
+  //  distance of the last expanded label, below which every distance is final
+  std::uint64_t settled_distance;
+  std::uint64_t reached_count;
+  std::uint64_t frontier_size;
+
+  [[nodiscard]] std::uint64_t get_byte_count() const {
+    return sizeof(search_checkpoint_header_type)
+      + people_count * sizeof(time_to_cross_type)
+      + reached_count * sizeof(search_checkpoint_reached_state_type)
+      + frontier_size * label_byte_count;
+  }
+};
+
+//  writes checkpoints on a thread of its own, from one buffer the search fills while no checkpoint is
+//  being written. the search skips a checkpoint rather than wait when the previous one is still being
+//  written, so its only pause is copying the reached states out. each checkpoint is synced to disk and
+//  then replaces the file at path whole, through a rename.
+struct checkpoint_writer_type {
+  explicit checkpoint_writer_type(std::string path)
+    : path {std::move(path)},
+      writer {[this](std::stop_token const &stop) { write_until(stop); }} {
+  }
+
+  checkpoint_writer_type(checkpoint_writer_type const &) = delete;
+  checkpoint_writer_type &operator=(checkpoint_writer_type const &) = delete;
+
+  //  finishes the checkpoint being written
+  ~checkpoint_writer_type() {
+    writer.request_stop();
+  }
+
+  //  the buffer to fill with the next checkpoint, or nullptr while the previous one is being written.
+  //  rethrows what failed that one.
+  std::vector<std::byte> *try_begin() {
+    std::scoped_lock const lock {writer_mutex};
+    rethrow_error();
+    return is_writing ? nullptr : &buffer;
+  }
+
+  //  hands the buffer from try_begin to the writer
+  void commit() {
+    {
+      std::scoped_lock const lock {writer_mutex};
+      is_writing = true;
+    }
+    writer_condition.notify_all();
+  }
+
+  //  until the committed checkpoint is on disk. rethrows what failed it.
+  void wait() {
+    std::unique_lock lock {writer_mutex};
+    writer_condition.wait(lock, [&] { return !is_writing; });
+    rethrow_error();
+  }
+
+  private:
+  void write_until(std::stop_token const &stop) {
+    std::unique_lock lock {writer_mutex};
+
+    while (true) {
+      writer_condition.wait(lock, stop, [&] { return is_writing; });
+      if (!is_writing) {
+        return;
+      }
+
+      lock.unlock();
+      std::exception_ptr write_error;
+      try {
+        write(buffer);
+      } catch (...) {
+        write_error = std::current_exception();
+      }
+      lock.lock();
+
+      error = write_error;
+      is_writing = false;
+      writer_condition.notify_all();
+    }
+  }
+
+  void write(std::span<std::byte const> const bytes) const {
+    ROPE_BRIDGE_TRACE_SPAN_ARG("write_checkpoint", bytes.size());
+    auto const partial_path = path + ".partial";
+    auto const file_descriptor = ::open(partial_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (file_descriptor == -1) {
+      throw std::system_error(errno, std::generic_category(), std::format("cannot open {}", partial_path));
+    }
+
+    for (std::size_t written_byte_count = 0; written_byte_count < bytes.size();) {
+      auto const byte_count = ::write(
+        file_descriptor, bytes.data() + written_byte_count, bytes.size() - written_byte_count
+      );
+      if (byte_count == -1 && errno == EINTR) {
+        continue;
+      }
+      if (byte_count == -1) {
+        auto const error = errno;
+        ::close(file_descriptor);
+        throw std::system_error(error, std::generic_category(), std::format("cannot write {}", partial_path));
+      }
+      written_byte_count += static_cast<std::size_t>(byte_count);
+    }
+
+    //  on disk before the rename, so a crash leaves either this checkpoint or the last one whole
+    if (::fsync(file_descriptor) == -1) {
+      auto const error = errno;
+      ::close(file_descriptor);
+      throw std::system_error(error, std::generic_category(), std::format("cannot sync {}", partial_path));
+    }
+    if (::close(file_descriptor) == -1) {
+      throw std::system_error(errno, std::generic_category(), std::format("cannot write {}", partial_path));
+    }
+    std::filesystem::rename(partial_path, path);
+  }
+
+  void rethrow_error() {
+    if (error) {
+      std::rethrow_exception(std::exchange(error, nullptr));
+    }
+  }
+
+  std::string const path;
+  std::mutex writer_mutex;
+  std::condition_variable_any writer_condition;
+  bool is_writing = false;
+  std::exception_ptr error;
+  //  filled by the search while !is_writing, read by the writer while is_writing
+  std::vector<std::byte> buffer;
+  //  last, so it stops before the members it uses go
+  std::jthread writer;
+};
+
+struct checkpoint_options_type {
+  std::string path;
+  //  between checkpoints, measured from the end of the last
+  std::chrono::nanoseconds interval;
+  //  continue from the checkpoint at path when there is one. it must be for the same times.
+  bool resume;
+};
+
+//  the optimal schedule by Dijkstra over the implicit graph, as solve_fixed, checkpointing its
+//  reached states, their predecessors and its frontier to options.path every options.interval so a run killed
+//  part way resumes from its last checkpoint instead of from the start. observer is called as in
+//  solver_observer.hpp, and after a resume only for the labels expanded since.
+template <typename observer_type = null_solver_observer_type>
+fixed_schedule_type solve_checkpointed(
+  std::span<time_to_cross_type const> const times_to_cross,
+  checkpoint_options_type const &options,
+  observer_type &&observer = {}
+) {
+  using int_value_type = bridge_state_type::int_value_type;
+  ROPE_BRIDGE_TRACE_SPAN_ARG("solve_checkpointed", times_to_cross.size());
+
+  auto const people_count = times_to_cross.size();
+  auto const leading_one = bridge_state_type::start(people_count).state_repr;
+  //  offsets from leading_one
+  auto const start_offset = int_value_type {0};
+  auto const end_offset = leading_one - 1;
+  //  expansions between looks at the clock
+  auto constexpr pops_per_clock_check = std::uint64_t {1} << 12;
+
+  struct label_type {
+    time_to_cross_type distance;
+    int_value_type state_offset;
+
+    bool operator>(label_type const &other) const {
+      return distance > other.distance;
+    }
+  };
+
+  auto constexpr unreached = std::numeric_limits<time_to_cross_type>::max();
+  tracked_vector_type<time_to_cross_type, memory_category_type::solver_scratch> distances(leading_one, unreached);
+  tracked_vector_type<int_value_type, memory_category_type::solver_scratch> predecessors(leading_one, start_offset);
+  //  a min-heap by std::greater, kept in a vector so checkpoints can copy it
+  tracked_vector_type<label_type, memory_category_type::solver_scratch> frontier;
+  search_checkpoint_header_type progress {
+    .magic = search_checkpoint_header_type::checkpoint_magic,
+    .people_count = people_count,
+    .pop_count = 0,
+    .settled_distance = 0,
+    .reached_count = 0,
+    .frontier_size = 0
+  };
+
+  //  appends the bytes of values to a checkpoint
+  auto const copy_out = [](std::byte *&position, auto const &values) {
+    auto const byte_count = std::span {values}.size_bytes();
+    std::memcpy(position, values.data(), byte_count);
+    position += byte_count;
+  };
+
+  if (options.resume && std::filesystem::exists(options.path)) {
+    std::ifstream input {options.path, std::ios::binary};
+    auto const read = [&](auto &values) {
+      input.read(reinterpret_cast<char *>(values.data()), static_cast<std::streamsize>(std::span {values}.size_bytes()));
+    };
+
+    auto const make_mismatch_error = [&] {
+      return std::invalid_argument(std::format(
+        "checkpoint {} is out of range. should be for the same {} times to cross.", options.path, people_count
+      ));
+    };
+
+    std::vector<time_to_cross_type> checkpoint_times(people_count);
+    input.read(reinterpret_cast<char *>(&progress), sizeof(progress));
+    if (input && progress.magic == search_checkpoint_header_type::checkpoint_magic && progress.people_count == people_count) {
+      read(checkpoint_times);
+    }
+    //  the counts are bounded before get_byte_count so it cannot wrap
+    auto const file_size = std::filesystem::file_size(options.path);
+    if (
+      !input
+      || progress.magic != search_checkpoint_header_type::checkpoint_magic
+      || progress.people_count != people_count
+      || !std::ranges::equal(checkpoint_times, times_to_cross)
+      || progress.reached_count > leading_one
+      || progress.frontier_size > file_size / search_checkpoint_header_type::label_byte_count
+      || file_size != progress.get_byte_count()
+    ) {
+      throw make_mismatch_error();
+    }
+
+    for (std::uint64_t reached_index = 0; reached_index < progress.reached_count; ++reached_index) {
+      search_checkpoint_reached_state_type reached_state {};
+      input.read(reinterpret_cast<char *>(&reached_state), sizeof(reached_state));
+      if (!input || reached_state.state_offset >= leading_one || reached_state.predecessor_offset >= leading_one) {
+        throw make_mismatch_error();
+      }
+      distances[reached_state.state_offset] = reached_state.distance;
+      predecessors[reached_state.state_offset] = reached_state.predecessor_offset;
+    }
+    //  counted again, as the next checkpoint is sized by it
+    progress.reached_count = static_cast<std::uint64_t>(std::ranges::count_if(
+      distances, [&](time_to_cross_type const distance) { return distance != unreached; }
+    ));
+
+    frontier.resize(progress.frontier_size);
+    read(frontier);
+    if (!input || std::ranges::any_of(frontier, [&](label_type const &label) { return label.state_offset >= leading_one; })) {
+      throw make_mismatch_error();
+    }
+  } else {
+    distances[start_offset] = 0;
+    progress.reached_count = 1;
+    frontier.push_back({.distance = 0, .state_offset = start_offset});
+  }
+
+  checkpoint_writer_type writer {options.path};
+  auto last_checkpoint_time = std::chrono::steady_clock::now();
+
+  auto const try_checkpoint = [&] {
+    auto *const buffer = writer.try_begin();
+    if (buffer == nullptr) {
+      return;
+    }
+
+    progress.frontier_size = frontier.size();
+    buffer->resize(progress.get_byte_count());
+    auto *position = buffer->data();
+    copy_out(position, std::span {&progress, 1});
+    copy_out(position, times_to_cross);
+    for (auto state_offset = start_offset; state_offset <= end_offset; ++state_offset) {
+      if (distances[state_offset] == unreached) {
+        continue;
+      }
+      search_checkpoint_reached_state_type const reached_state {
+        .state_offset = state_offset,
+        .distance = distances[state_offset],
+        .predecessor_offset = predecessors[state_offset]
+      };
+      copy_out(position, std::span {&reached_state, 1});
+    }
+    copy_out(position, frontier);
+    writer.commit();
+
+    last_checkpoint_time = std::chrono::steady_clock::now();
+  };
+
+  while (!frontier.empty()) {
+    std::ranges::pop_heap(frontier, std::greater<> {});
+    auto const label = frontier.back();
+    frontier.pop_back();
+
+    if (label.distance > distances[label.state_offset]) {
+      continue;
+    }
+    auto const state_repr = label.state_offset + leading_one;
+    if (label.state_offset == end_offset) {
+      observer.on_goal(state_repr, label.distance);
+      break;
+    }
+    observer.on_pop(state_repr, label.distance, frontier.size());
+    progress.settled_distance = static_cast<std::uint64_t>(label.distance);
+
+    auto const relax = [&](int_value_type const crossed_state_repr, time_to_cross_type const time_to_cross) {
+      auto const distance = label.distance + time_to_cross;
+      observer.on_relax(state_repr, crossed_state_repr, distance);
+      if (distance >= distances[crossed_state_repr - leading_one]) {
+        return;
+      }
+      observer.on_improve(state_repr, crossed_state_repr, distance);
+      if (distances[crossed_state_repr - leading_one] == unreached) {
+        ++progress.reached_count;
+      }
+      distances[crossed_state_repr - leading_one] = distance;
+      predecessors[crossed_state_repr - leading_one] = label.state_offset;
+      frontier.push_back({.distance = distance, .state_offset = crossed_state_repr - leading_one});
+      std::ranges::push_heap(frontier, std::greater<> {});
+    };
+
+    for_each_possible_crossing(state_repr, people_count, times_to_cross, relax);
+
+    if (
+      ++progress.pop_count % pops_per_clock_check == 0
+      && std::chrono::steady_clock::now() - last_checkpoint_time >= options.interval
+    ) {
+      try_checkpoint();
+    }
+  }
+
+  //  surfaces a failed write rather than leaving it unnoticed
+  writer.wait();
+
+  fixed_schedule_type result {
+    .total_time = distances[end_offset],
+    .state_reprs = {end_offset + leading_one}
+  };
+  for (auto state_offset = end_offset; state_offset != start_offset;) {
+    state_offset = predecessors[state_offset];
+    result.state_reprs.push_back(state_offset + leading_one);
+  }
+  std::ranges::reverse(result.state_reprs);
+
+  return result;
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+
+#include "bridge_state.hpp"
+#include "mapped_file.hpp"
+#include "memory_tracking.hpp"
+
+//  the state graph as compressed sparse rows, with the states in the order of build_state_graph: the
+//  crossings of state i lead to crossing_state_indices[crossing_offsets[i]] up to
+//  crossing_state_indices[crossing_offsets[i + 1]]. crossing_times holds their times alongside, or is
+//  empty in a compact graph, whose crossings are weighed by their crossers as get_time_to_cross does.
+//
+//  all arrays share one buffer, either allocated or in a file mapping, so the graph can be moved but
+//  not copied.
+struct csr_state_graph_type {
+  using int_value_type = bridge_state_type::int_value_type;
+  //  state counts stay below 2^31
+  using state_index_type = std::uint32_t;
+  using crossing_offset_type = std::uint64_t;
+
+  static std::uint64_t get_state_count(std::size_t const people_count) {
+    return (std::uint64_t {1} << (people_count + 1)) - 2;
+  }
+
+  //  a state with k people on the side of the torch has k + k (k - 1) / 2 crossings, which sums to
+  //  n (n + 3) 2^(n - 2) over the states
+  static std::uint64_t get_crossing_count(std::size_t const people_count) {
+    return (std::uint64_t {people_count} * (people_count + 3) << people_count) / 4;
+  }
+
+  static std::uint64_t get_byte_count(std::size_t const people_count, bool const with_times) {
+    return get_layout(people_count, with_times).byte_count;
+  }
+
+  static csr_state_graph_type allocate(std::size_t const people_count, bool const with_times) {
+    auto const layout = get_layout(people_count, with_times);
+
+    csr_state_graph_type result;
+    result.buffer.resize((layout.byte_count + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t));
+    result.bind(reinterpret_cast<std::byte *>(result.buffer.data()), layout);
+    return result;
+  }
+
+  //  in a new file at path, which must not exist yet and is unlinked once created, so the kernel writes
+  //  the graph out and reads it back as memory runs short and the file goes with the mapping
+  static csr_state_graph_type map(std::string const &path, std::size_t const people_count, bool const with_times) {
+    auto const layout = get_layout(people_count, with_times);
+
+    csr_state_graph_type result;
+    result.file.emplace(mapped_file_type::create_scratch(path, layout.byte_count));
+
+    result.bind(result.file->get_writable_bytes().data(), layout);
+    return result;
+  }
+
+  csr_state_graph_type(csr_state_graph_type &&) = default;
+  csr_state_graph_type &operator=(csr_state_graph_type &&) = default;
+  csr_state_graph_type(csr_state_graph_type const &) = delete;
+  csr_state_graph_type &operator=(csr_state_graph_type const &) = delete;
+
+  [[nodiscard]] std::size_t get_state_count() const {
+    return state_reprs.size();
+  }
+
+  [[nodiscard]] bool is_compact() const {
+    return crossing_times.empty();
+  }
+
+  [[nodiscard]] time_to_cross_type get_time_to_cross(
+    std::size_t const state_index,
+    crossing_offset_type const crossing_position,
+    std::span<time_to_cross_type const> const times_to_cross
+  ) const {
+    if (!is_compact()) {
+      return crossing_times[crossing_position];
+    }
+    auto const crossers = (state_reprs[state_index] ^ state_reprs[crossing_state_indices[crossing_position]]) >> 1;
+    return std::max(times_to_cross[std::countr_zero(crossers)], times_to_cross[std::bit_width(crossers) - 1]);
+  }
+
+  //  get_state_count() + 1 entries
+  std::span<crossing_offset_type> crossing_offsets;
+  std::span<int_value_type> state_reprs;
+  std::span<state_index_type> crossing_state_indices;
+  std::span<time_to_cross_type> crossing_times;
+
+  private:
+  //  byte offsets into the buffer, widest elements first so none needs padding
+  struct layout_type {
+    std::uint64_t state_count;
+    std::uint64_t crossing_count;
+    std::uint64_t state_reprs_offset;
+    std::uint64_t crossing_state_indices_offset;
+    std::uint64_t crossing_times_offset;
+    std::uint64_t byte_count;
+  };
+
+  static layout_type get_layout(std::size_t const people_count, bool const with_times) {
+    auto const state_count = get_state_count(people_count);
+    auto const crossing_count = get_crossing_count(people_count);
+    auto const state_reprs_offset = (state_count + 1) * sizeof(crossing_offset_type);
+    auto const crossing_state_indices_offset = state_reprs_offset + state_count * sizeof(int_value_type);
+    auto const crossing_times_offset = crossing_state_indices_offset + crossing_count * sizeof(state_index_type);
+
+    return {
+      .state_count = state_count,
+      .crossing_count = crossing_count,
+      .state_reprs_offset = state_reprs_offset,
+      .crossing_state_indices_offset = crossing_state_indices_offset,
+      .crossing_times_offset = crossing_times_offset,
+      .byte_count = crossing_times_offset + (with_times ? crossing_count * sizeof(time_to_cross_type) : 0)
+    };
+  }
+
+  csr_state_graph_type() = default;
+
+  void bind(std::byte *const bytes, layout_type const &layout) {
+    crossing_offsets = {reinterpret_cast<crossing_offset_type *>(bytes), layout.state_count + 1};
+    state_reprs = {reinterpret_cast<int_value_type *>(bytes + layout.state_reprs_offset), layout.state_count};
+    crossing_state_indices = {
+      reinterpret_cast<state_index_type *>(bytes + layout.crossing_state_indices_offset), layout.crossing_count
+    };
+    crossing_times = {
+      reinterpret_cast<time_to_cross_type *>(bytes + layout.crossing_times_offset),
+      (layout.byte_count - layout.crossing_times_offset) / sizeof(time_to_cross_type)
+    };
+  }
+
+  tracked_vector_type<std::uint64_t, memory_category_type::csr_graph> buffer;
+  std::optional<mapped_file_type> file;
+};
@@ -0,0 +1,248 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "bridge_state.hpp"
+
+//  maintains the optimal total time of a group as people join and leave, in O(log n) expected per
+//  update and query.
+//
+//  with times sorted ascending as a1 <= a2 <= … <= an, an optimal schedule sends the slowest people
+//  either one at a time escorted by a1, or in pairs after a1 and a2 ferry the torch. sending the
+//  pair with d as its faster member rather than escorting both changes the total by 2 a2 - a1 - d,
+//  which only grows further down, so the optimum is
+//    (n - 2) a1 + a2 + (a3 + … + an) + sum of (2 a2 - a1 - d) over d in {2nd, 4th, 6th, … slowest}
+//    with d > 2 a2 - a1
+//
+//  times are kept in a treap ordered slowest first where every subtree knows the sum of the times at
+//  its even positions, which gives that sum over any slowest prefix by one descent.
+//
+//  for groups within max_people, solve_shortest_path over build_state_graph of the same times gives
+//  the same total and serves as a cross-check.
+struct dynamic_optimum_type {
+  using total_time_type = std::int64_t;
+
+  void insert(time_to_cross_type const time) {
+    auto const inserted_node_index = allocate_node(time);
+    auto const [slower_root_index, rest_root_index] = split_slower(root_index, time);
+    root_index = merge(merge(slower_root_index, inserted_node_index), rest_root_index);
+  }
+
+  void erase(time_to_cross_type const time) {
+    auto const [slower_root_index, rest_root_index] = split_slower(root_index, time);
+    auto const [equal_root_index, faster_root_index] = split_slower(rest_root_index, time - 1);
+
+    if (equal_root_index == no_node) {
+      root_index = merge(slower_root_index, faster_root_index);
+      throw std::invalid_argument(std::format("time is out of range. is {}. should be in the group.", time));
+    }
+
+    auto const &erased_node = nodes.at(equal_root_index);
+    auto const remaining_equal_root_index = merge(erased_node.slower_index, erased_node.faster_index);
+    free_node_indices.push_back(equal_root_index);
+    root_index = merge(merge(slower_root_index, remaining_equal_root_index), faster_root_index);
+  }
+
+  [[nodiscard]] std::size_t get_people_count() const {
+    return get_count(root_index);
+  }
+
+  [[nodiscard]] total_time_type get_total_time() const {
+    auto const people_count = get_people_count();
+
+    if (people_count == 0) {
+      return 0;
+    }
+    if (people_count <= 2) {
+      return get_slowest(0);
+    }
+
+    total_time_type const fastest = get_slowest(people_count - 1);
+    total_time_type const second_fastest = get_slowest(people_count - 2);
+    auto const pair_threshold = 2 * second_fastest - fastest;
+
+    //  only times above pair_threshold >= a2 gain from pairing, so a1 and a2 are never counted
+    std::size_t paired_candidate_count = 0;
+    for (auto node_index = root_index; node_index != no_node;) {
+      auto const &node = nodes.at(node_index);
+      if (node.time > pair_threshold) {
+        paired_candidate_count += get_count(node.slower_index) + 1;
+        node_index = node.faster_index;
+      } else {
+        node_index = node.slower_index;
+      }
+    }
+
+    auto const paired_count = static_cast<total_time_type>(paired_candidate_count / 2);
+
+    return static_cast<total_time_type>(people_count - 2) * fastest
+      + get_sum(root_index) - fastest
+      + paired_count * pair_threshold - get_slowest_even_position_sum(paired_candidate_count);
+  }
+
+  private:
+  static auto constexpr no_node = std::size_t {static_cast<std::size_t>(-1)};
+
+  struct node_type {
+    time_to_cross_type time;
+    std::uint32_t priority;
+    std::size_t slower_index;
+    std::size_t faster_index;
+    std::size_t count;
+    total_time_type sum;
+    //  sum of the times at the 2nd, 4th, … position of this subtree, slowest first
+    total_time_type even_position_sum;
+  };
+
+  [[nodiscard]] std::size_t get_count(std::size_t const node_index) const {
+    return node_index == no_node ? 0 : nodes.at(node_index).count;
+  }
+
+  [[nodiscard]] total_time_type get_sum(std::size_t const node_index) const {
+    return node_index == no_node ? 0 : nodes.at(node_index).sum;
+  }
+
+  [[nodiscard]] total_time_type get_even_position_sum(std::size_t const node_index) const {
+    return node_index == no_node ? 0 : nodes.at(node_index).even_position_sum;
+  }
+
+  void update(std::size_t const node_index) {
+    auto &node = nodes.at(node_index);
+    auto const node_position = get_count(node.slower_index) + 1;
+
+    node.count = node_position + get_count(node.faster_index);
+    node.sum = get_sum(node.slower_index) + node.time + get_sum(node.faster_index);
+    //  an odd node_position keeps the parity of the faster subtree's positions, an even one flips it
+    node.even_position_sum = get_even_position_sum(node.slower_index)
+      + (node_position % 2 == 0
+        ? node.time + get_even_position_sum(node.faster_index)
+        : get_sum(node.faster_index) - get_even_position_sum(node.faster_index));
+  }
+
+  //  the time at 0-based position from the slowest
+  [[nodiscard]] time_to_cross_type get_slowest(std::size_t position) const {
+    auto node_index = root_index;
+
+    while (true) {
+      auto const &node = nodes.at(node_index);
+      auto const slower_count = get_count(node.slower_index);
+      if (position < slower_count) {
+        node_index = node.slower_index;
+      } else if (position == slower_count) {
+        return node.time;
+      } else {
+        position -= slower_count + 1;
+        node_index = node.faster_index;
+      }
+    }
+  }
+
+  //  sum of the times at the 2nd, 4th, … position among the prefix_count slowest
+  [[nodiscard]] total_time_type get_slowest_even_position_sum(std::size_t prefix_count) const {
+    total_time_type result = 0;
+    std::size_t positions_before = 0;
+
+    for (auto node_index = root_index; node_index != no_node && prefix_count > 0;) {
+      auto const &node = nodes.at(node_index);
+      auto const slower_count = get_count(node.slower_index);
+
+      if (prefix_count <= slower_count) {
+        node_index = node.slower_index;
+        continue;
+      }
+
+      auto const slower_even_position_sum = get_even_position_sum(node.slower_index);
+      result += positions_before % 2 == 0
+        ? slower_even_position_sum
+        : get_sum(node.slower_index) - slower_even_position_sum;
+      if ((positions_before + slower_count + 1) % 2 == 0) {
+        result += node.time;
+      }
+
+      positions_before += slower_count + 1;
+      prefix_count -= slower_count + 1;
+      node_index = node.faster_index;
+    }
+
+    return result;
+  }
+
+  //  splits into the times greater than time and the rest
+  std::pair<std::size_t, std::size_t> split_slower(std::size_t const node_index, time_to_cross_type const time) {
+    if (node_index == no_node) {
+      return {no_node, no_node};
+    }
+
+    auto &node = nodes.at(node_index);
+    if (node.time > time) {
+      auto const [slower_index, faster_index] = split_slower(node.faster_index, time);
+      nodes.at(node_index).faster_index = slower_index;
+      update(node_index);
+      return {node_index, faster_index};
+    }
+
+    auto const [slower_index, faster_index] = split_slower(node.slower_index, time);
+    nodes.at(node_index).slower_index = faster_index;
+    update(node_index);
+    return {slower_index, node_index};
+  }
+
+  //  every time in slower_node_index must be at least every time in faster_node_index
+  std::size_t merge(std::size_t const slower_node_index, std::size_t const faster_node_index) {
+    if (slower_node_index == no_node) {
+      return faster_node_index;
+    }
+    if (faster_node_index == no_node) {
+      return slower_node_index;
+    }
+
+    if (nodes.at(slower_node_index).priority > nodes.at(faster_node_index).priority) {
+      auto const merged_index = merge(nodes.at(slower_node_index).faster_index, faster_node_index);
+      nodes.at(slower_node_index).faster_index = merged_index;
+      update(slower_node_index);
+      return slower_node_index;
+    }
+
+    auto const merged_index = merge(slower_node_index, nodes.at(faster_node_index).slower_index);
+    nodes.at(faster_node_index).slower_index = merged_index;
+    update(faster_node_index);
+    return faster_node_index;
+  }
+
+  std::size_t allocate_node(time_to_cross_type const time) {
+    //  xorshift32
+    priority_state ^= priority_state << 13;
+    priority_state ^= priority_state >> 17;
+    priority_state ^= priority_state << 5;
+
+    node_type const node {
+      .time = time,
+      .priority = priority_state,
+      .slower_index = no_node,
+      .faster_index = no_node,
+      .count = 1,
+      .sum = time,
+      .even_position_sum = 0
+    };
+
+    if (free_node_indices.empty()) {
+      nodes.push_back(node);
+      return nodes.size() - 1;
+    }
+
+    auto const node_index = free_node_indices.back();
+    free_node_indices.pop_back();
+    nodes.at(node_index) = node;
+    return node_index;
+  }
+
+  std::vector<node_type> nodes;
+  std::vector<std::size_t> free_node_indices;
+  std::size_t root_index = no_node;
+  std::uint32_t priority_state = 2463534242u;
+};
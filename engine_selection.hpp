@@ -0,0 +1,319 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <fstream>
+#include <limits>
+#include <optional>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <unistd.h>
+
+#include "bridge_state.hpp"
+#include "budgeted_state_graph.hpp"
+#include "dynamic_optimum.hpp"
+#include "fixed_people_count.hpp"
+#include "shortest_path.hpp"
+#include "state_graph.hpp"
+#include "work_stealing.hpp"
+#include "work_stealing_batch.hpp"
+
+enum class solve_engine_type {
+  //  dynamic_optimum_type, the total time only, in O(n log n)
+  closed_form,
+  //  solve_fixed over the implicit graph
+  implicit,
+  //  build_fixed_state_graph and solve_shortest_path
+  materialized,
+  //  solve_delta_stepping on a work_stealing_scheduler_type
+  delta_stepping
+};
+
+inline std::string_view get_solve_engine_name(solve_engine_type const engine) {
+  static constexpr std::array<std::string_view, 4> names {"closed_form", "implicit", "materialized", "delta_stepping"};
+  return names.at(static_cast<std::size_t>(engine));
+}
+
+//  what a caller needs, each including the ones before it
+enum class solve_output_type {
+  total_time,
+  schedule,
+  //  the whole state graph, for the analyses that take states_list_type
+  state_graph
+};
+
+//  bytes the engines need at their peak for people_count people, from the sizes of their tables.
+//  materialized is the adjacency_lists representation of budgeted_state_graph.hpp, whose estimate
+//  covers the dense index table of build_fixed_state_graph and the scratch of solve_shortest_path.
+inline std::uint64_t get_estimated_engine_bytes(solve_engine_type const engine, std::size_t const people_count) {
+  auto const state_count = (std::uint64_t {1} << (people_count + 1)) - 2;
+
+  switch (engine) {
+    case solve_engine_type::closed_form:
+      return people_count * 64;
+    case solve_engine_type::implicit:
+      //  distances and predecessors, plus a frontier about as large
+      return state_count * 2 * (sizeof(time_to_cross_type) + sizeof(bridge_state_type::int_value_type));
+    case solve_engine_type::delta_stepping:
+      //  packed labels plus the frontier and bucket vectors
+      return state_count * (sizeof(std::uint64_t) + 3 * sizeof(bridge_state_type::int_value_type));
+    case solve_engine_type::materialized:
+      return get_estimated_representation_bytes(state_graph_representation_type::adjacency_lists, people_count);
+  }
+  return std::numeric_limits<std::uint64_t>::max();
+}
+
+//  MemAvailable of /proc/meminfo, or the free physical pages where that is missing
+inline std::uint64_t get_available_memory_bytes() {
+  std::ifstream meminfo {"/proc/meminfo"};
+  std::string key;
+  std::uint64_t kibibytes;
+  std::string unit;
+
+  while (meminfo >> key >> kibibytes >> unit) {
+    if (key == "MemAvailable:") {
+      return kibibytes * 1024;
+    }
+  }
+  return static_cast<std::uint64_t>(::sysconf(_SC_AVPHYS_PAGES)) * static_cast<std::uint64_t>(::sysconf(_SC_PAGESIZE));
+}
+
+//  nanoseconds per unit of get_estimated_solve_cost for every engine that explores the state space,
+//  measured once on this machine and kept on disk. delta_stepping is measured with worker_count
+//  workers, which is what solve_auto gives it.
+struct engine_calibration_type {
+  static auto constexpr format_version = 1;
+
+  double implicit_ns_per_cost;
+  double materialized_ns_per_cost;
+  double delta_stepping_ns_per_cost;
+  std::size_t worker_count;
+
+  //  solves random instances with every engine, each for at least min_duration
+  static engine_calibration_type measure(
+    std::size_t const worker_count,
+    std::chrono::nanoseconds const min_duration = std::chrono::milliseconds {100}
+  ) {
+    if (worker_count == 0) {
+      throw std::invalid_argument("worker_count is out of range. is 0. should be positive.");
+    }
+
+    std::mt19937 generator {1};
+    std::uniform_int_distribution<time_to_cross_type> time_distribution {1, 1000};
+    work_stealing_scheduler_type scheduler {worker_count};
+
+    auto const get_ns_per_cost = [&](std::size_t const people_count, auto const &solve) {
+      std::vector<time_to_cross_type> times_to_cross(people_count);
+      std::uint64_t total_cost = 0;
+      auto const start = std::chrono::steady_clock::now();
+
+      do {
+        std::ranges::generate(times_to_cross, [&] { return time_distribution(generator); });
+        solve(times_to_cross);
+        total_cost += get_estimated_solve_cost(people_count);
+      } while (std::chrono::steady_clock::now() - start < min_duration);
+
+      auto const elapsed_ns = std::chrono::duration<double, std::nano> {std::chrono::steady_clock::now() - start};
+      return elapsed_ns.count() / static_cast<double>(total_cost);
+    };
+
+    return {
+      .implicit_ns_per_cost = get_ns_per_cost(12, [](std::vector<time_to_cross_type> const &times_to_cross) {
+        static_cast<void>(solve_fixed(times_to_cross));
+      }),
+      .materialized_ns_per_cost = get_ns_per_cost(12, [](std::vector<time_to_cross_type> const &times_to_cross) {
+        static_cast<void>(solve_shortest_path(build_fixed_state_graph(times_to_cross)));
+      }),
+      .delta_stepping_ns_per_cost = get_ns_per_cost(14, [&](std::vector<time_to_cross_type> const &times_to_cross) {
+        //  from a worker, so its rounds fork
+        scheduler.submit(0, [&] {
+          static_cast<void>(solve_delta_stepping(times_to_cross, scheduler));
+        });
+        scheduler.wait_idle();
+      }),
+      .worker_count = worker_count
+    };
+  }
+
+  //  the calibration stored at path for worker_count workers, or else a fresh one, which is then stored
+  static engine_calibration_type load_or_measure(std::string const &path, std::size_t const worker_count) {
+    if (auto const loaded = load(path); loaded && loaded->worker_count == worker_count) {
+      return *loaded;
+    }
+
+    auto const measured = measure(worker_count);
+    measured.store(path);
+    return measured;
+  }
+
+  //  std::nullopt when path is missing, of another format_version or unreadable
+  static std::optional<engine_calibration_type> load(std::string const &path) {
+    std::ifstream input {path};
+    std::string key;
+    int version;
+    engine_calibration_type result {
+      .implicit_ns_per_cost = 0,
+      .materialized_ns_per_cost = 0,
+      .delta_stepping_ns_per_cost = 0,
+      .worker_count = 0
+    };
+
+    if (!(input >> key >> version) || key != "format_version" || version != format_version) {
+      return std::nullopt;
+    }
+    input >> key >> result.implicit_ns_per_cost
+      >> key >> result.materialized_ns_per_cost
+      >> key >> result.delta_stepping_ns_per_cost
+      >> key >> result.worker_count;
+    if (!input || result.worker_count == 0) {
+      return std::nullopt;
+    }
+    return result;
+  }
+
+  void store(std::string const &path) const {
+    std::ofstream output {path, std::ios::trunc};
+    output << std::format(
+      "format_version {}\nimplicit_ns_per_cost {}\nmaterialized_ns_per_cost {}\n"
+      "delta_stepping_ns_per_cost {}\nworker_count {}\n",
+      format_version, implicit_ns_per_cost, materialized_ns_per_cost, delta_stepping_ns_per_cost, worker_count
+    );
+  }
+};
+
+struct engine_choice_type {
+  solve_engine_type engine;
+  std::size_t thread_count;
+  double estimated_seconds;
+  std::uint64_t estimated_bytes;
+};
+
+//  the fastest engine by calibration that gives output within available_bytes. calibration is not read
+//  for solve_output_type::total_time, which the closed form answers.
+inline engine_choice_type choose_engine(
+  std::size_t const people_count,
+  solve_output_type const output,
+  std::uint64_t const available_bytes,
+  engine_calibration_type const &calibration
+) {
+  if (output == solve_output_type::total_time) {
+    return {
+      .engine = solve_engine_type::closed_form,
+      .thread_count = 1,
+      .estimated_seconds = 0,
+      .estimated_bytes = get_estimated_engine_bytes(solve_engine_type::closed_form, people_count)
+    };
+  }
+
+  //  validates the people count of the graph-based engines
+  static_cast<void>(bridge_state_type::start(people_count));
+
+  auto const cost = static_cast<double>(get_estimated_solve_cost(people_count));
+  auto const make_choice = [&](solve_engine_type const engine, double const ns_per_cost, std::size_t const thread_count) {
+    return engine_choice_type {
+      .engine = engine,
+      .thread_count = thread_count,
+      .estimated_seconds = ns_per_cost * cost * 1e-9,
+      .estimated_bytes = get_estimated_engine_bytes(engine, people_count)
+    };
+  };
+
+  std::vector<engine_choice_type> candidates {
+    make_choice(solve_engine_type::materialized, calibration.materialized_ns_per_cost, 1)
+  };
+  if (output == solve_output_type::schedule) {
+    candidates.push_back(make_choice(solve_engine_type::implicit, calibration.implicit_ns_per_cost, 1));
+    candidates.push_back(make_choice(
+      solve_engine_type::delta_stepping, calibration.delta_stepping_ns_per_cost, calibration.worker_count
+    ));
+  }
+
+  std::erase_if(candidates, [&](engine_choice_type const &candidate) {
+    return candidate.estimated_bytes > available_bytes;
+  });
+  if (candidates.empty()) {
+    throw std::invalid_argument(std::format(
+      "people_count is out of range. is {}. should fit the output in {} bytes.", people_count, available_bytes
+    ));
+  }
+
+  return *std::ranges::min_element(candidates, {}, &engine_choice_type::estimated_seconds);
+}
+
+struct auto_solution_type {
+  engine_choice_type choice;
+  std::int64_t total_time;
+  //  from the start state to the end state, empty for solve_output_type::total_time
+  std::vector<bridge_state_type::int_value_type> state_reprs;
+  //  only for solve_output_type::state_graph
+  states_list_type states;
+};
+
+//  output for times_to_cross from the engine choose_engine picks
+inline auto_solution_type solve_auto(
+  std::span<time_to_cross_type const> const times_to_cross,
+  solve_output_type const output,
+  std::uint64_t const available_bytes,
+  engine_calibration_type const &calibration
+) {
+  auto_solution_type result {
+    .choice = choose_engine(times_to_cross.size(), output, available_bytes, calibration),
+    .total_time = 0,
+    .state_reprs = {},
+    .states = {}
+  };
+
+  auto const take_schedule = [&](fixed_schedule_type &&schedule) {
+    result.total_time = schedule.total_time;
+    result.state_reprs = std::move(schedule.state_reprs);
+  };
+
+  switch (result.choice.engine) {
+    case solve_engine_type::closed_form: {
+      dynamic_optimum_type optimum;
+      for (auto const time_to_cross : times_to_cross) {
+        optimum.insert(time_to_cross);
+      }
+      result.total_time = optimum.get_total_time();
+      break;
+    }
+    case solve_engine_type::implicit:
+      take_schedule(solve_fixed(times_to_cross));
+      break;
+    case solve_engine_type::materialized: {
+      auto states = build_fixed_state_graph(times_to_cross);
+      auto const path = solve_shortest_path(states);
+      result.total_time = path.total_time;
+      for (auto const state_index : path.state_indices) {
+        result.state_reprs.push_back(states.at(state_index).state_repr);
+      }
+      //  otherwise freed here rather than kept alongside the schedule
+      if (output == solve_output_type::state_graph) {
+        result.states = std::move(states);
+      }
+      break;
+    }
+    case solve_engine_type::delta_stepping: {
+      work_stealing_scheduler_type scheduler {result.choice.thread_count};
+      fixed_schedule_type schedule;
+      scheduler.submit(0, [&] {
+        schedule = solve_delta_stepping(times_to_cross, scheduler);
+      });
+      scheduler.wait_idle();
+      take_schedule(std::move(schedule));
+      break;
+    }
+  }
+
+  return result;
+}
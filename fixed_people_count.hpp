@@ -0,0 +1,372 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <format>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "bridge_state.hpp"
+#include "csr_state_graph.hpp"
+#include "memory_tracking.hpp"
+#include "solver_observer.hpp"
+#include "state_graph.hpp"
+
+struct fixed_schedule_type {
+  time_to_cross_type total_time;
+  //  from the start state to the end state
+  std::vector<bridge_state_type::int_value_type> state_reprs;
+};
+
+//  calls on_crossing(crossed_state_repr, time_to_cross) for every single crossing and then every double
+//  crossing from state_repr of people_count people, in the order of build_state_graph. shared by every
+//  solver that walks the implicit graph. people_count is a std::size_t, or a std::integral_constant of
+//  one to instantiate the crosser loops with constant bounds.
+template <typename people_count_type, typename on_crossing_type>
+void for_each_possible_crossing(
+  bridge_state_type::int_value_type const state_repr,
+  people_count_type const people_count,
+  std::span<time_to_cross_type const> const times,
+  on_crossing_type const &on_crossing
+) {
+  using int_value_type = bridge_state_type::int_value_type;
+  auto const people_mask = (int_value_type {1} << people_count) - 1;
+  auto const crossed_people = state_repr >> 1 & people_mask;
+  auto const possible_crosser_indices = (state_repr & 1) == 1 ? crossed_people : crossed_people ^ people_mask;
+
+  for (std::size_t crosser_index = 0; crosser_index < people_count; ++crosser_index) {
+    if ((possible_crosser_indices >> crosser_index & 1) == 0) {
+      continue;
+    }
+    on_crossing(state_repr ^ 1 ^ int_value_type {2} << crosser_index, times[crosser_index]);
+  }
+
+  for (std::size_t first_crosser_index = 0; first_crosser_index < people_count; ++first_crosser_index) {
+    if ((possible_crosser_indices >> first_crosser_index & 1) == 0) {
+      continue;
+    }
+    for (auto second_crosser_index = first_crosser_index + 1; second_crosser_index < people_count; ++second_crosser_index) {
+      if ((possible_crosser_indices >> second_crosser_index & 1) == 0) {
+        continue;
+      }
+      on_crossing(
+        state_repr ^ 1 ^ int_value_type {2} << first_crosser_index ^ int_value_type {2} << second_crosser_index,
+        std::max(times[first_crosser_index], times[second_crosser_index])
+      );
+    }
+  }
+}
+
+//  the builder and solver with people_count fixed at compile time, so the masks are constants, the
+//  crosser loops have constant bounds and every state is found through a dense table indexed by
+//  state_repr instead of a map. the tables are arrays for small counts and vectors past that.
+//  times_to_cross must already have people_count entries, which the dispatching functions below check.
+template <std::size_t people_count>
+struct fixed_people_count_type {
+  static_assert(people_count >= bridge_state_type::min_people && people_count <= bridge_state_type::max_people);
+
+  using int_value_type = bridge_state_type::int_value_type;
+
+  //  the same graph as build_state_graph, state for state and crossing for crossing
+  static states_list_type build_state_graph(std::span<time_to_cross_type const> const times_to_cross) {
+    std::span<time_to_cross_type const, people_count> const times {times_to_cross.data(), people_count};
+
+    states_list_type states;
+    states.reserve(max_possible_states);
+
+    auto state_index_by_repr = make_table<std::size_t>(no_state_index);
+
+    auto const add_state = [&](int_value_type const state_repr) {
+      state_index_by_repr[state_repr - leading_one] = states.size();
+      states.push_back({.state_repr = state_repr, .possible_crossings = {}});
+    };
+
+    add_state(start_repr);
+    add_state(end_repr);
+
+    for (std::size_t curr_state_index = 0; curr_state_index < states.size(); ++curr_state_index) {
+      for_each_crossing(
+        states[curr_state_index].state_repr,
+        times,
+        [&](int_value_type const crossed_state_repr, time_to_cross_type const time_to_cross) {
+          auto crossed_state_index = state_index_by_repr[crossed_state_repr - leading_one];
+
+          if (crossed_state_index == no_state_index) {
+            crossed_state_index = states.size();
+            add_state(crossed_state_repr);
+          } else if (crossed_state_index <= curr_state_index) {
+            return;
+          }
+
+          states[curr_state_index].possible_crossings.push_back({
+            .state_index_after_crossing = crossed_state_index,
+            .time_to_cross = time_to_cross
+          });
+          states[crossed_state_index].possible_crossings.push_back({
+            .state_index_after_crossing = curr_state_index,
+            .time_to_cross = time_to_cross
+          });
+        }
+      );
+    }
+
+    return states;
+  }
+
+  //  the graph of build_state_graph into graph, allocated for people_count, with the crossings of every
+  //  state in the order of for_each_crossing rather than that of build_state_graph
+  static void fill_csr_state_graph(
+    std::span<time_to_cross_type const> const times_to_cross,
+    csr_state_graph_type &graph
+  ) {
+    std::span<time_to_cross_type const, people_count> const times {times_to_cross.data(), people_count};
+
+    using state_index_type = csr_state_graph_type::state_index_type;
+    auto constexpr no_csr_state_index = std::numeric_limits<state_index_type>::max();
+    auto state_index_by_repr = make_table<state_index_type>(no_csr_state_index);
+    std::size_t state_count = 0;
+
+    auto const add_state = [&](int_value_type const state_repr) {
+      state_index_by_repr[state_repr - leading_one] = static_cast<state_index_type>(state_count);
+      graph.state_reprs[state_count] = state_repr;
+      return static_cast<state_index_type>(state_count++);
+    };
+
+    add_state(start_repr);
+    add_state(end_repr);
+
+    auto const with_times = !graph.is_compact();
+    csr_state_graph_type::crossing_offset_type crossing_count = 0;
+
+    for (std::size_t curr_state_index = 0; curr_state_index < state_count; ++curr_state_index) {
+      graph.crossing_offsets[curr_state_index] = crossing_count;
+
+      for_each_crossing(
+        graph.state_reprs[curr_state_index],
+        times,
+        [&](int_value_type const crossed_state_repr, time_to_cross_type const time_to_cross) {
+          auto crossed_state_index = state_index_by_repr[crossed_state_repr - leading_one];
+          if (crossed_state_index == no_csr_state_index) {
+            crossed_state_index = add_state(crossed_state_repr);
+          }
+
+          graph.crossing_state_indices[crossing_count] = crossed_state_index;
+          if (with_times) {
+            graph.crossing_times[crossing_count] = time_to_cross;
+          }
+          ++crossing_count;
+        }
+      );
+    }
+    graph.crossing_offsets[state_count] = crossing_count;
+
+    assert(state_count == graph.get_state_count());
+    assert(crossing_count == graph.crossing_state_indices.size());
+  }
+
+  //  Dijkstra over the implicit graph, without building it
+  static fixed_schedule_type solve(std::span<time_to_cross_type const> const times_to_cross) {
+    return solve(times_to_cross, null_solver_observer_type {});
+  }
+
+  //  solve, calling observer as in solver_observer.hpp
+  template <typename observer_type>
+  static fixed_schedule_type solve(std::span<time_to_cross_type const> const times_to_cross, observer_type &&observer) {
+    std::span<time_to_cross_type const, people_count> const times {times_to_cross.data(), people_count};
+
+    auto constexpr unreached = std::numeric_limits<time_to_cross_type>::max();
+    auto distances = make_table<time_to_cross_type>(unreached);
+    auto predecessors = make_table<int_value_type>(start_repr);
+
+    struct label_type {
+      time_to_cross_type distance;
+      int_value_type state_repr;
+
+      bool operator>(label_type const &other) const {
+        return distance > other.distance;
+      }
+    };
+    std::priority_queue<
+      label_type, tracked_vector_type<label_type, memory_category_type::solver_scratch>, std::greater<>
+    > frontier;
+
+    distances[start_repr - leading_one] = 0;
+    frontier.push({.distance = 0, .state_repr = start_repr});
+
+    while (!frontier.empty()) {
+      auto const label = frontier.top();
+      frontier.pop();
+
+      if (label.distance > distances[label.state_repr - leading_one]) {
+        continue;
+      }
+      if (label.state_repr == end_repr) {
+        observer.on_goal(label.state_repr, label.distance);
+        break;
+      }
+      observer.on_pop(label.state_repr, label.distance, frontier.size());
+
+      for_each_crossing(
+        label.state_repr,
+        times,
+        [&](int_value_type const crossed_state_repr, time_to_cross_type const time_to_cross) {
+          auto const distance = label.distance + time_to_cross;
+          observer.on_relax(label.state_repr, crossed_state_repr, distance);
+          if (distance >= distances[crossed_state_repr - leading_one]) {
+            return;
+          }
+          observer.on_improve(label.state_repr, crossed_state_repr, distance);
+          distances[crossed_state_repr - leading_one] = distance;
+          predecessors[crossed_state_repr - leading_one] = label.state_repr;
+          frontier.push({.distance = distance, .state_repr = crossed_state_repr});
+        }
+      );
+    }
+
+    fixed_schedule_type result {
+      .total_time = distances[end_repr - leading_one],
+      .state_reprs = {end_repr}
+    };
+    for (auto state_repr = end_repr; state_repr != start_repr;) {
+      state_repr = predecessors[state_repr - leading_one];
+      result.state_reprs.push_back(state_repr);
+    }
+    std::ranges::reverse(result.state_reprs);
+
+    return result;
+  }
+
+  private:
+  static auto constexpr people_mask = (int_value_type {1} << people_count) - 1;
+  static auto constexpr leading_one = int_value_type {1} << (people_count + 1);
+  static auto constexpr start_repr = leading_one;
+  static auto constexpr end_repr = (leading_one << 1) - 1;
+  static auto constexpr max_possible_states = (std::size_t {1} << (people_count + 1)) - 2;
+  static auto constexpr no_state_index = static_cast<std::size_t>(-1);
+
+  //  indexed by state_repr - leading_one
+  static auto constexpr table_size = std::size_t {leading_one};
+  static auto constexpr max_array_table_size = std::size_t {1} << 12;
+
+  template <typename value_type>
+  using table_type = std::conditional_t<
+    table_size <= max_array_table_size,
+    std::array<value_type, table_size>,
+    tracked_vector_type<value_type, memory_category_type::solver_scratch>
+  >;
+
+  template <typename value_type>
+  static table_type<value_type> make_table(value_type const initial_value) {
+    if constexpr (table_size <= max_array_table_size) {
+      table_type<value_type> result;
+      result.fill(initial_value);
+      return result;
+    } else {
+      return table_type<value_type>(table_size, initial_value);
+    }
+  }
+
+  //  for_each_possible_crossing instantiated for people_count itself, so its masks are constants and its
+  //  loops have constant bounds whether or not it is inlined here
+  template <typename on_crossing_type>
+  static void for_each_crossing(
+    int_value_type const state_repr,
+    std::span<time_to_cross_type const, people_count> const times,
+    on_crossing_type const &on_crossing
+  ) {
+    for_each_possible_crossing(state_repr, std::integral_constant<std::size_t, people_count> {}, times, on_crossing);
+  }
+};
+
+template <std::size_t... people_count_offsets>
+auto constexpr make_fixed_build_state_graph_table(std::index_sequence<people_count_offsets...>) {
+  return std::array<states_list_type (*)(std::span<time_to_cross_type const>), sizeof...(people_count_offsets)> {
+    &fixed_people_count_type<people_count_offsets + bridge_state_type::min_people>::build_state_graph...
+  };
+}
+
+template <std::size_t... people_count_offsets>
+auto constexpr make_fixed_fill_csr_state_graph_table(std::index_sequence<people_count_offsets...>) {
+  return std::array<
+    void (*)(std::span<time_to_cross_type const>, csr_state_graph_type &),
+    sizeof...(people_count_offsets)
+  > {
+    &fixed_people_count_type<people_count_offsets + bridge_state_type::min_people>::fill_csr_state_graph...
+  };
+}
+
+template <std::size_t... people_count_offsets>
+auto constexpr make_fixed_solve_table(std::index_sequence<people_count_offsets...>) {
+  return std::array<fixed_schedule_type (*)(std::span<time_to_cross_type const>), sizeof...(people_count_offsets)> {
+    &fixed_people_count_type<people_count_offsets + bridge_state_type::min_people>::solve...
+  };
+}
+
+template <typename observer_type, std::size_t... people_count_offsets>
+auto constexpr make_fixed_observed_solve_table(std::index_sequence<people_count_offsets...>) {
+  return std::array<
+    fixed_schedule_type (*)(std::span<time_to_cross_type const>, observer_type &),
+    sizeof...(people_count_offsets)
+  > {
+    &fixed_people_count_type<people_count_offsets + bridge_state_type::min_people>::template solve<observer_type &>...
+  };
+}
+
+using fixed_people_count_offsets_type = std::make_index_sequence<
+  bridge_state_type::max_people - bridge_state_type::min_people + 1
+>;
+
+//  build_state_graph through the instantiation for times_to_cross.size()
+inline states_list_type build_fixed_state_graph(std::span<time_to_cross_type const> const times_to_cross) {
+  static auto constexpr table = make_fixed_build_state_graph_table(fixed_people_count_offsets_type {});
+
+  //  validates the people count
+  static_cast<void>(bridge_state_type::start(times_to_cross.size()));
+  return table[times_to_cross.size() - bridge_state_type::min_people](times_to_cross);
+}
+
+//  fill_csr_state_graph through the instantiation for times_to_cross.size(), into a graph from
+//  csr_state_graph_type::allocate or map for as many people
+inline void fill_fixed_csr_state_graph(
+  std::span<time_to_cross_type const> const times_to_cross,
+  csr_state_graph_type &graph
+) {
+  static auto constexpr table = make_fixed_fill_csr_state_graph_table(fixed_people_count_offsets_type {});
+
+  //  validates the people count
+  static_cast<void>(bridge_state_type::start(times_to_cross.size()));
+  if (graph.get_state_count() != csr_state_graph_type::get_state_count(times_to_cross.size())) {
+    throw std::invalid_argument(std::format(
+      "graph state count is out of range. is {}. should be {}.",
+      graph.get_state_count(), csr_state_graph_type::get_state_count(times_to_cross.size())
+    ));
+  }
+  table[times_to_cross.size() - bridge_state_type::min_people](times_to_cross, graph);
+}
+
+//  the optimal schedule through the instantiation for times_to_cross.size()
+inline fixed_schedule_type solve_fixed(std::span<time_to_cross_type const> const times_to_cross) {
+  static auto constexpr table = make_fixed_solve_table(fixed_people_count_offsets_type {});
+
+  //  validates the people count
+  static_cast<void>(bridge_state_type::start(times_to_cross.size()));
+  return table[times_to_cross.size() - bridge_state_type::min_people](times_to_cross);
+}
+
+//  solve_fixed, calling observer as in solver_observer.hpp
+template <typename observer_type>
+fixed_schedule_type solve_fixed(std::span<time_to_cross_type const> const times_to_cross, observer_type &observer) {
+  static auto constexpr table = make_fixed_observed_solve_table<observer_type>(fixed_people_count_offsets_type {});
+
+  //  validates the people count
+  static_cast<void>(bridge_state_type::start(times_to_cross.size()));
+  return table[times_to_cross.size() - bridge_state_type::min_people](times_to_cross, observer);
+}
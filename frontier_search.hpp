@@ -0,0 +1,244 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "bridge_state.hpp"
+#include "ida_star.hpp"
+#include "memory_tracking.hpp"
+#include "tracing.hpp"
+
+struct frontier_search_schedule_type {
+  std::int64_t total_time;
+  //  from the start state to the end state
+  std::vector<wide_state_repr_type> state_reprs;
+  //  most states any search held in one layer
+  std::size_t max_layer_size;
+  //  searches run, one per threshold round and one per split of the path
+  std::size_t search_count;
+  std::uint64_t expanded_count;
+};
+
+//  the optimal schedule by breadth-first iterative-deepening A*, holding only the layer being expanded
+//  and the next rather than every state, for people counts no table of states fits but whose paths are
+//  wanted whole.
+//
+//  the crossings tried are those of slowest_first_people_type::for_each_crossing. as they take two
+//  people over and bring one back, the people over and the side of the torch fix how many crossings a
+//  state is from the start, so the graph is layered by crossing count and a state is only ever reached
+//  again in its own layer, where the copies reached later are dropped. states whose time plus the
+//  admissible slowest_first_people_type::get_remaining_time_bound exceeds a threshold are pruned. the
+//  first round's threshold is that bound of the start state and every later one is picked by
+//  cut_off_histogram_type. as the earliest copy of every state is kept, the first round reaching the
+//  end state reaches it at the optimal time even when its threshold is past it.
+//
+//  no layer keeps predecessors. instead the states past the middle layer carry their ancestor in it,
+//  the relay, so a search yields the relay of the end state and the path is rebuilt by searching from
+//  the start to the relay and from the relay to the end in turn, recursively, until the segments are
+//  single crossings. the searches towards a relay are bounded by its known time and estimate the time
+//  left by the slowest person on the wrong side.
+//
+//  the layers are as large as the states within the threshold, which stays small for times taking few
+//  distinct values and grows exponentially with the people count for spread out times, as the work of
+//  ida_star_search_type does.
+struct frontier_search_type {
+  static auto constexpr max_people = ida_star_search_type::max_people;
+
+  static frontier_search_schedule_type solve(std::span<time_to_cross_type const> const times_to_cross) {
+    ROPE_BRIDGE_TRACE_SPAN_ARG("solve_frontier_search", times_to_cross.size());
+
+    auto const people_count = times_to_cross.size();
+    if (people_count < bridge_state_type::min_people || people_count > max_people) {
+      throw std::invalid_argument(bridge_state_error_type {
+        .kind = bridge_state_error_type::kind_type::people_count_out_of_range,
+        .value = people_count,
+        .min_value = bridge_state_type::min_people,
+        .max_value = max_people
+      }.get_message());
+    }
+
+    frontier_search_type search {times_to_cross};
+    search.result.state_reprs.push_back(search.start_repr);
+
+    if (people_count == 1) {
+      search.result.total_time = times_to_cross[0];
+      search.result.state_reprs.push_back(search.end_repr);
+    } else {
+      auto const layer_count = search.get_layer(search.end_repr) - search.get_layer(search.start_repr);
+      for (auto threshold = search.people.get_remaining_time_bound(search.start_repr);;) {
+        cut_off_histogram_type cut_offs {threshold};
+        auto const prior_expanded_count = search.result.expanded_count;
+
+        if (auto const goal = search.find_relay(search.start_repr, search.end_repr, threshold, layer_count, &cut_offs)) {
+          search.result.total_time = goal->time;
+          search.append_path_through(search.start_repr, *goal, layer_count);
+          break;
+        }
+        threshold = cut_offs.get_next_threshold(search.result.expanded_count - prior_expanded_count);
+      }
+    }
+
+    for (auto &state_repr : search.result.state_reprs) {
+      state_repr = search.people.get_original_state_repr(state_repr);
+    }
+    return std::move(search.result);
+  }
+
+  private:
+  struct node_type {
+    wide_state_repr_type state_repr;
+    std::int64_t time;
+    //  the ancestor in the middle layer, and its time
+    wide_state_repr_type relay_repr;
+    std::int64_t relay_time;
+  };
+
+  using layer_type = tracked_vector_type<node_type, memory_category_type::solver_scratch>;
+
+  //  states a layer may grow to before its duplicates are dropped
+  static auto constexpr min_compaction_size = std::size_t {1} << 16;
+
+  explicit frontier_search_type(std::span<time_to_cross_type const> const times_to_cross)
+    : people {times_to_cross},
+      start_repr {wide_state_repr_type {1} << (times_to_cross.size() + 1)},
+      end_repr {(start_repr << 1) - 1},
+      result {.total_time = 0, .state_reprs = {}, .max_layer_size = 0, .search_count = 0, .expanded_count = 0} {
+  }
+
+  //  crossings from the start: c people over take 2c crossings with the torch here, where every
+  //  return has left it, and 2c - 3 with it over
+  [[nodiscard]] std::size_t get_layer(wide_state_repr_type const state_repr) const {
+    auto const crossed_count = static_cast<std::size_t>(std::popcount(state_repr >> 1 & people.people_mask));
+    return (state_repr & 1) == 1 ? 2 * crossed_count - 3 : 2 * crossed_count;
+  }
+
+  [[nodiscard]] std::int64_t get_remaining_time_bound(
+    wide_state_repr_type const state_repr,
+    wide_state_repr_type const goal_repr
+  ) const {
+    if (goal_repr == end_repr) {
+      return people.get_remaining_time_bound(state_repr);
+    }
+    //  everyone on the wrong side crosses at least once
+    auto const wrong_side_people = (state_repr ^ goal_repr) >> 1 & people.people_mask;
+    return wrong_side_people == 0 ? 0 : people.times[static_cast<std::size_t>(std::countr_zero(wrong_side_people))];
+  }
+
+  //  appends the states after source_repr of an optimal path to goal_repr, layer_count crossings and
+  //  total_time away
+  void append_path(
+    wide_state_repr_type const source_repr,
+    wide_state_repr_type const goal_repr,
+    std::int64_t const total_time,
+    std::size_t const layer_count
+  ) {
+    if (layer_count == 1) {
+      result.state_reprs.push_back(goal_repr);
+      return;
+    }
+
+    auto const goal = find_relay(source_repr, goal_repr, total_time, layer_count, nullptr);
+    if (!goal) {
+      throw std::logic_error("frontier search found no path within the optimal total time");
+    }
+    append_path_through(source_repr, *goal, layer_count);
+  }
+
+  //  appends the states after source_repr of the path find_relay found to goal, layer_count crossings away
+  void append_path_through(wide_state_repr_type const source_repr, node_type const &goal, std::size_t const layer_count) {
+    if (layer_count == 1) {
+      result.state_reprs.push_back(goal.state_repr);
+      return;
+    }
+
+    auto const middle_layer = layer_count / 2;
+    append_path(source_repr, goal.relay_repr, goal.relay_time, middle_layer);
+    append_path(goal.relay_repr, goal.state_repr, goal.time - goal.relay_time, layer_count - middle_layer);
+  }
+
+  //  the earliest node of goal_repr reached from source_repr within threshold, carrying its ancestor
+  //  layer_count / 2 crossings along, else nullopt. the estimates past threshold go to cut_offs unless
+  //  it is nullptr.
+  std::optional<node_type> find_relay(
+    wide_state_repr_type const source_repr,
+    wide_state_repr_type const goal_repr,
+    std::int64_t const threshold,
+    std::size_t const layer_count,
+    cut_off_histogram_type *const cut_offs
+  ) {
+    ROPE_BRIDGE_TRACE_SPAN_ARG("find_relay", layer_count);
+    ++result.search_count;
+
+    auto const middle_layer = layer_count / 2;
+    layer_type layer {{.state_repr = source_repr, .time = 0, .relay_repr = source_repr, .relay_time = 0}};
+    layer_type next_layer;
+
+    for (std::size_t layer_index = 1; layer_index <= layer_count; ++layer_index) {
+      next_layer.clear();
+      auto compaction_size = min_compaction_size;
+
+      auto const add_node = [&](node_type const &node, wide_state_repr_type const crossed_state_repr, std::int64_t const time_to_cross) {
+        auto const time = node.time + time_to_cross;
+        auto const estimate = time + get_remaining_time_bound(crossed_state_repr, goal_repr);
+        if (estimate > threshold) {
+          if (cut_offs != nullptr) {
+            cut_offs->add(estimate);
+          }
+          return;
+        }
+        next_layer.push_back(layer_index == middle_layer
+          ? node_type {.state_repr = crossed_state_repr, .time = time, .relay_repr = crossed_state_repr, .relay_time = time}
+          : node_type {.state_repr = crossed_state_repr, .time = time, .relay_repr = node.relay_repr, .relay_time = node.relay_time}
+        );
+        if (next_layer.size() >= compaction_size) {
+          compact(next_layer);
+          compaction_size = std::max(min_compaction_size, next_layer.size() * 2);
+        }
+      };
+
+      for (auto const &node : layer) {
+        ++result.expanded_count;
+        people.for_each_crossing(node.state_repr, [&](wide_state_repr_type const crossed_state_repr, std::int64_t const time_to_cross) {
+          add_node(node, crossed_state_repr, time_to_cross);
+        });
+      }
+
+      compact(next_layer);
+      result.max_layer_size = std::max(result.max_layer_size, next_layer.size());
+      std::swap(layer, next_layer);
+    }
+
+    //  the last layer holds only states within no time of goal_repr, which is goal_repr itself
+    auto const goal = std::ranges::find(layer, goal_repr, &node_type::state_repr);
+    if (goal == layer.end()) {
+      return std::nullopt;
+    }
+    return *goal;
+  }
+
+  //  keeps the earliest node of every state
+  static void compact(layer_type &layer) {
+    std::ranges::sort(layer, [](node_type const &node, node_type const &other) {
+      return std::pair {node.state_repr, node.time} < std::pair {other.state_repr, other.time};
+    });
+    auto const duplicates = std::ranges::unique(layer, {}, &node_type::state_repr);
+    layer.erase(duplicates.begin(), duplicates.end());
+  }
+
+  slowest_first_people_type const people;
+  wide_state_repr_type const start_repr;
+  wide_state_repr_type const end_repr;
+  frontier_search_schedule_type result;
+};
+
+//  frontier_search_type::solve
+inline frontier_search_schedule_type solve_frontier_search(std::span<time_to_cross_type const> const times_to_cross) {
+  return frontier_search_type::solve(times_to_cross);
+}
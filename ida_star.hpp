@@ -0,0 +1,341 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include "bridge_state.hpp"
+#include "memory_tracking.hpp"
+#include "tracing.hpp"
+
+//  state_repr of solve_ida_star, laid out as bridge_state_type::state_repr but 64 bits wide, so past
+//  bridge_state_type::max_people
+using wide_state_repr_type = std::uint64_t;
+
+//  the people of an instance numbered slowest first, so the people on a side in order of time are the
+//  bits of its wide_state_repr_type from the lowest, with their indices in times_to_cross for mapping
+//  back
+struct slowest_first_people_type {
+  explicit slowest_first_people_type(std::span<time_to_cross_type const> const times_to_cross)
+    : people_mask {(wide_state_repr_type {1} << times_to_cross.size()) - 1},
+      original_indices(times_to_cross.size()),
+      times(times_to_cross.size()) {
+    std::iota(original_indices.begin(), original_indices.end(), std::size_t {0});
+    std::ranges::stable_sort(original_indices, std::ranges::greater {}, [&](std::size_t const index) {
+      return times_to_cross[index];
+    });
+    for (std::size_t person_index = 0; person_index < times.size(); ++person_index) {
+      times[person_index] = times_to_cross[original_indices[person_index]];
+    }
+  }
+
+  //  state_repr with the people numbered as in times_to_cross
+  [[nodiscard]] wide_state_repr_type get_original_state_repr(wide_state_repr_type const state_repr) const {
+    auto result = (wide_state_repr_type {2} << times.size()) | (state_repr & 1);
+    for (std::size_t person_index = 0; person_index < times.size(); ++person_index) {
+      result |= (state_repr >> (person_index + 1) & 1) << (original_indices[person_index] + 1);
+    }
+    return result;
+  }
+
+  //  a lower bound of the time from state_repr to the end state by schedules taking two people over
+  //  and bringing one back at a time. with k people to go, k - 1 forward trips when the torch is here
+  //  and k when it is over, all of two people from the second person on. the ones taking people to go
+  //  cost at least the slower of every two of them in order of time, and a lone one with someone else
+  //  at least the second fastest time; the others cost at least that too, and every return at least
+  //  the fastest time.
+  [[nodiscard]] std::int64_t get_remaining_time_bound(wide_state_repr_type const state_repr) const {
+    auto const people_to_go = (state_repr >> 1 & people_mask) ^ people_mask;
+    auto const people_to_go_count = std::popcount(people_to_go);
+    auto const torch_crossed = (state_repr & 1) == 1;
+    if (people_to_go_count == 0) {
+      return 0;
+    }
+    if (people_to_go_count == 1 && !torch_crossed) {
+      return times[static_cast<std::size_t>(std::countr_zero(people_to_go))];
+    }
+
+    auto const fastest_time = times.back();
+    auto const second_fastest_time = times[times.size() - 2];
+
+    std::int64_t result = 0;
+    for (auto trip_leaders = people_to_go; trip_leaders != 0;) {
+      auto const leader_time = times[static_cast<std::size_t>(std::countr_zero(trip_leaders))];
+      trip_leaders &= trip_leaders - 1;
+      result += trip_leaders == 0 ? std::max(leader_time, second_fastest_time) : leader_time;
+      trip_leaders &= trip_leaders - 1;
+    }
+
+    auto const other_forward_count = people_to_go_count / 2 - (torch_crossed ? 0 : 1);
+    auto const return_count = torch_crossed ? people_to_go_count : people_to_go_count - 2;
+    return result + other_forward_count * second_fastest_time + return_count * fastest_time;
+  }
+
+  //  calls on_crossing(crossed_state_repr, time_to_cross) for every crossing of two people over, of the
+  //  fastest person over back, and of the last person to go alone. some optimal schedule is made of
+  //  these only: sending one person over with others left to go or bringing two back never shortens a
+  //  schedule, and the optimal schedules of dynamic_optimum_type bring back the fastest person over.
+  template <typename on_crossing_type>
+  void for_each_crossing(wide_state_repr_type const state_repr, on_crossing_type &&on_crossing) const {
+    auto const crossed_people = state_repr >> 1 & people_mask;
+    auto const people_to_go = crossed_people ^ people_mask;
+
+    if ((state_repr & 1) == 1) {
+      auto const returner_index = static_cast<std::size_t>(std::bit_width(crossed_people) - 1);
+      on_crossing(state_repr ^ 1 ^ wide_state_repr_type {2} << returner_index, times[returner_index]);
+    } else if (std::popcount(people_to_go) == 1) {
+      auto const person_index = static_cast<std::size_t>(std::countr_zero(people_to_go));
+      on_crossing(state_repr ^ 1 ^ wide_state_repr_type {2} << person_index, times[person_index]);
+    } else {
+      //  the lower bit of a pair is its slower person. people with equal times are interchangeable, so
+      //  of those to go only the first is taken, which keeps the ones over the first of every such group
+      //  and the one brought back the last of them.
+      auto const is_repeat = [&](std::size_t const person_index, wide_state_repr_type const candidates) {
+        return person_index != 0 && (candidates >> (person_index - 1) & 1) == 1 && times[person_index - 1] == times[person_index];
+      };
+      for (auto slower_people = people_to_go; slower_people != 0; slower_people &= slower_people - 1) {
+        auto const slower_person_index = static_cast<std::size_t>(std::countr_zero(slower_people));
+        if (is_repeat(slower_person_index, people_to_go)) {
+          continue;
+        }
+        auto const faster_candidates = slower_people & (slower_people - 1);
+        for (auto faster_people = faster_candidates; faster_people != 0; faster_people &= faster_people - 1) {
+          auto const faster_person_index = static_cast<std::size_t>(std::countr_zero(faster_people));
+          if (is_repeat(faster_person_index, faster_candidates)) {
+            continue;
+          }
+          on_crossing(
+            state_repr ^ 1 ^ wide_state_repr_type {2} << slower_person_index ^ wide_state_repr_type {2} << faster_person_index,
+            times[slower_person_index]
+          );
+        }
+      }
+    }
+  }
+
+  wide_state_repr_type people_mask;
+  std::vector<std::size_t> original_indices;
+  //  by this numbering
+  std::vector<std::int64_t> times;
+};
+
+//  the estimates a threshold round cuts off, counted in bucket_count buckets past its threshold, for
+//  picking the next threshold where about as many states were cut off as the round expanded. raising
+//  the threshold to the least estimate cut off instead takes a round per distinct estimate when times
+//  are spread out, while this roughly doubles the work per round.
+struct cut_off_histogram_type {
+  static auto constexpr bucket_count = std::size_t {64};
+  //  the buckets span bucket_count / bucket_width_divisor of the threshold past it
+  static auto constexpr bucket_width_divisor = std::int64_t {256};
+
+  explicit cut_off_histogram_type(std::int64_t const threshold)
+    : threshold {threshold}, bucket_width {std::max<std::int64_t>(1, threshold / bucket_width_divisor)} {
+  }
+
+  //  estimate is past threshold
+  void add(std::int64_t const estimate) {
+    min_estimate = std::min(min_estimate, estimate);
+    auto const bucket_index = static_cast<std::size_t>((estimate - threshold - 1) / bucket_width);
+    if (bucket_index < bucket_count) {
+      ++counts[bucket_index];
+    }
+  }
+
+  //  the end of the first bucket by which as many states were cut off as expanded_count, else of the
+  //  last bucket, and at least the least estimate cut off. the maximum when nothing was cut off.
+  [[nodiscard]] std::int64_t get_next_threshold(std::uint64_t const expanded_count) const {
+    std::uint64_t cut_off_count = 0;
+    auto bucket_index = std::size_t {0};
+    for (; bucket_index < bucket_count - 1; ++bucket_index) {
+      cut_off_count += counts[bucket_index];
+      if (cut_off_count >= expanded_count) {
+        break;
+      }
+    }
+    if (min_estimate == std::numeric_limits<std::int64_t>::max()) {
+      return min_estimate;
+    }
+    return std::max(min_estimate, threshold + static_cast<std::int64_t>(bucket_index + 1) * bucket_width);
+  }
+
+  std::int64_t threshold;
+  std::int64_t bucket_width;
+  std::int64_t min_estimate = std::numeric_limits<std::int64_t>::max();
+  std::array<std::uint64_t, bucket_count> counts {};
+};
+
+struct ida_star_schedule_type {
+  std::int64_t total_time;
+  //  from the start state to the end state
+  std::vector<wide_state_repr_type> state_reprs;
+  //  threshold rounds run, the last of which found the schedule
+  std::size_t iteration_count;
+  std::uint64_t expanded_count;
+};
+
+//  the optimal schedule by iterative-deepening A*, in memory proportional to the number of crossings
+//  rather than the states, for people counts no table of states fits.
+//
+//  the crossings tried are those of slowest_first_people_type::for_each_crossing, in order of their
+//  time plus the admissible slowest_first_people_type::get_remaining_time_bound. the first round is
+//  bounded by that bound of the start state and every later one as cut_off_histogram_type picks. a
+//  round that reaches the end state lowers its threshold below every schedule found and runs on as a
+//  branch and bound, so the last schedule found is optimal: every path within the threshold has been
+//  tried.
+//
+//  a transposition table of 2^transposition_table_bits entries keyed by state_repr skips a state
+//  reached again in a round at no lower time.
+//
+//  the work still grows exponentially with the people count in general. times taking few distinct
+//  values keep the bound close to the optimum and solve at any people count, while spread out times
+//  take seconds at 20 people and far longer past that.
+struct ida_star_search_type {
+  static auto constexpr max_people = std::size_t {std::numeric_limits<wide_state_repr_type>::digits - 2};
+
+  static ida_star_schedule_type solve(
+    std::span<time_to_cross_type const> const times_to_cross,
+    std::size_t const transposition_table_bits
+  ) {
+    ROPE_BRIDGE_TRACE_SPAN_ARG("solve_ida_star", times_to_cross.size());
+
+    auto const people_count = times_to_cross.size();
+    if (people_count < bridge_state_type::min_people || people_count > max_people) {
+      throw std::invalid_argument(bridge_state_error_type {
+        .kind = bridge_state_error_type::kind_type::people_count_out_of_range,
+        .value = people_count,
+        .min_value = bridge_state_type::min_people,
+        .max_value = max_people
+      }.get_message());
+    }
+    if (transposition_table_bits >= std::numeric_limits<std::size_t>::digits) {
+      throw std::invalid_argument(std::format(
+        "transposition_table_bits is out of range. is {}. should be below {}.",
+        transposition_table_bits, std::numeric_limits<std::size_t>::digits
+      ));
+    }
+
+    ida_star_search_type search {times_to_cross, transposition_table_bits};
+
+    search.threshold = search.people.get_remaining_time_bound(search.start_repr);
+    for (;;) {
+      ++search.result.iteration_count;
+      auto const prior_expanded_count = search.result.expanded_count;
+      search.cut_offs = cut_off_histogram_type {search.threshold};
+
+      search.search(search.start_repr, 0);
+      if (!search.best_path.empty()) {
+        break;
+      }
+      search.threshold = search.cut_offs.get_next_threshold(search.result.expanded_count - prior_expanded_count);
+    }
+
+    for (auto const state_repr : search.best_path) {
+      search.result.state_reprs.push_back(search.people.get_original_state_repr(state_repr));
+    }
+
+    return std::move(search.result);
+  }
+
+  private:
+  struct transposition_entry_type {
+    wide_state_repr_type state_repr;
+    std::int64_t time;
+    std::size_t iteration;
+  };
+
+  struct successor_type {
+    wide_state_repr_type state_repr;
+    std::int64_t time_to_cross;
+    std::int64_t estimate;
+  };
+
+  ida_star_search_type(std::span<time_to_cross_type const> const times_to_cross, std::size_t const transposition_table_bits)
+    : people {times_to_cross},
+      start_repr {wide_state_repr_type {1} << (times_to_cross.size() + 1)},
+      end_repr {(start_repr << 1) - 1},
+      transposition_table(std::size_t {1} << transposition_table_bits, {.state_repr = 0, .time = 0, .iteration = 0}),
+      path {start_repr},
+      result {.total_time = 0, .state_reprs = {}, .iteration_count = 0, .expanded_count = 0} {
+  }
+
+  //  searches the states within threshold from state_repr, reached at time, keeping the schedule
+  //  through the end state in best_path and lowering threshold below it
+  void search(wide_state_repr_type const state_repr, std::int64_t const time) {
+    if (state_repr == end_repr) {
+      result.total_time = time;
+      best_path = path;
+      threshold = time - 1;
+      return;
+    }
+
+    auto &entry = transposition_table[std::hash<wide_state_repr_type> {}(state_repr) & (transposition_table.size() - 1)];
+    if (entry.state_repr == state_repr && entry.iteration == result.iteration_count && entry.time <= time) {
+      return;
+    }
+    entry = {.state_repr = state_repr, .time = time, .iteration = result.iteration_count};
+    ++result.expanded_count;
+
+    auto const depth = path.size() - 1;
+    if (depth >= successors_by_depth.size()) {
+      successors_by_depth.resize(depth + 1);
+    }
+    auto &successors = successors_by_depth[depth];
+    successors.clear();
+
+    people.for_each_crossing(state_repr, [&](wide_state_repr_type const crossed_state_repr, std::int64_t const time_to_cross) {
+      auto const estimate = time + time_to_cross + people.get_remaining_time_bound(crossed_state_repr);
+      if (estimate > threshold) {
+        if (best_path.empty()) {
+          cut_offs.add(estimate);
+        }
+        return;
+      }
+      successors.push_back({.state_repr = crossed_state_repr, .time_to_cross = time_to_cross, .estimate = estimate});
+    });
+
+    std::ranges::sort(successors, {}, &successor_type::estimate);
+
+    //  by index, since successors_by_depth grows as the search goes deeper. threshold may have dropped
+    //  since a successor was added.
+    for (std::size_t successor_index = 0; successor_index < successors_by_depth[depth].size(); ++successor_index) {
+      auto const successor = successors_by_depth[depth][successor_index];
+      if (successor.estimate > threshold) {
+        break;
+      }
+      path.push_back(successor.state_repr);
+      search(successor.state_repr, time + successor.time_to_cross);
+      path.pop_back();
+    }
+  }
+
+  slowest_first_people_type const people;
+  wide_state_repr_type const start_repr;
+  wide_state_repr_type const end_repr;
+  tracked_vector_type<transposition_entry_type, memory_category_type::solver_scratch> transposition_table;
+  //  per depth, reused across rounds
+  std::vector<std::vector<successor_type>> successors_by_depth;
+  std::vector<wide_state_repr_type> path;
+  //  the best schedule found, empty until one is
+  std::vector<wide_state_repr_type> best_path;
+  std::int64_t threshold = 0;
+  //  of the current round, until it finds a schedule
+  cut_off_histogram_type cut_offs {0};
+  ida_star_schedule_type result;
+};
+
+//  ida_star_search_type::solve
+inline ida_star_schedule_type solve_ida_star(
+  std::span<time_to_cross_type const> const times_to_cross,
+  std::size_t const transposition_table_bits = 20
+) {
+  return ida_star_search_type::solve(times_to_cross, transposition_table_bits);
+}
@@ -0,0 +1,266 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <fstream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "bridge_state.hpp"
+#include "mapped_file.hpp"
+#include "tracing.hpp"
+
+//  parses the text format from curr up to last, stopping after max_instance_count instances. every
+//  instance's times are appended to times and its end offset in times to instance_offsets, whose last
+//  entry must be the current size of times. returns where parsing stopped.
+inline char const *parse_text_instances(
+  std::string const &path,
+  char const *curr,
+  char const *const last,
+  std::size_t const max_instance_count,
+  std::size_t &line_number,
+  std::vector<time_to_cross_type> &times,
+  std::vector<std::size_t> &instance_offsets
+) {
+  std::size_t instance_count = 0;
+
+  while (curr != last && instance_count < max_instance_count) {
+    if (*curr == ' ' || *curr == '\t' || *curr == '\r') {
+      ++curr;
+      continue;
+    }
+    if (*curr == '\n') {
+      if (times.size() != instance_offsets.back()) {
+        instance_offsets.push_back(times.size());
+        ++instance_count;
+      }
+      ++line_number;
+      ++curr;
+      continue;
+    }
+
+    time_to_cross_type time_to_cross;
+    auto const [next, error] = std::from_chars(curr, last, time_to_cross);
+    if (error != std::errc {} || time_to_cross < 0) {
+      throw std::invalid_argument(std::format(
+        "line {} of {} is out of range. should hold non-negative integer times.", line_number, path
+      ));
+    }
+    times.push_back(time_to_cross);
+    curr = next;
+  }
+
+  if (curr == last && times.size() != instance_offsets.back()) {
+    instance_offsets.push_back(times.size());
+  }
+  return curr;
+}
+
+struct instance_binary_header_type {
+  static auto constexpr binary_magic = std::uint64_t {0x31'53'45'43'4e'41'54'53ull};
+
+  std::uint64_t magic;
+  std::uint64_t people_count;
+  std::uint64_t instance_count;
+
+  //  the header of a file in the binary format, else nullptr. throws if its people count is out of
+  //  range or the size does not match it. the counts come from the file, so the size is checked
+  //  without multiplying them, which could wrap.
+  static instance_binary_header_type const *find(std::string const &path, std::span<std::byte const> const bytes) {
+    if (bytes.size() < sizeof(instance_binary_header_type)) {
+      return nullptr;
+    }
+
+    auto const header = reinterpret_cast<instance_binary_header_type const *>(bytes.data());
+    if (header->magic != binary_magic) {
+      return nullptr;
+    }
+
+    if (header->people_count < bridge_state_type::min_people || header->people_count > bridge_state_type::max_people) {
+      throw std::invalid_argument(std::format(
+        "people count of {} is out of range. is {}. should be in range [{}, {}].",
+        path, header->people_count, bridge_state_type::min_people, bridge_state_type::max_people
+      ));
+    }
+
+    auto const times_size = bytes.size() - sizeof(instance_binary_header_type);
+    auto const instance_size = header->people_count * sizeof(time_to_cross_type);
+    if (times_size % instance_size != 0 || times_size / instance_size != header->instance_count) {
+      throw std::invalid_argument(std::format(
+        "file size of {} is out of range. is {}. should hold {} instances of {} people after its header.",
+        path, bytes.size(), header->instance_count, header->people_count
+      ));
+    }
+
+    return header;
+  }
+
+  [[nodiscard]] std::span<time_to_cross_type const> get_times(std::span<std::byte const> const bytes) const {
+    return {
+      reinterpret_cast<time_to_cross_type const *>(bytes.data() + sizeof(instance_binary_header_type)),
+      people_count * instance_count
+    };
+  }
+};
+
+//  a file of instances, mapped rather than read, handing out each instance's times as a span.
+//
+//  two formats are recognized by their start:
+//  text: one instance per line, its times as decimal integers separated by spaces or tabs. blank lines
+//    are skipped. the integers are parsed with std::from_chars straight from the mapping into one
+//    flat array.
+//  binary: instance_binary_header_type followed by instance_count * people_count native-endian
+//    time_to_cross_type values. the spans point into the mapping itself, so nothing is parsed or copied.
+struct instance_file_type {
+  static instance_file_type open(std::string const &path) {
+    ROPE_BRIDGE_TRACE_SPAN("open_instance_file");
+    instance_file_type result {mapped_file_type::open_read_only(path)};
+    auto const bytes = result.file.get_bytes();
+
+    if (auto const header = instance_binary_header_type::find(path, bytes)) {
+      result.times = header->get_times(bytes);
+      result.instance_offsets.reserve(header->instance_count + 1);
+      for (std::size_t instance_index = 0; instance_index <= header->instance_count; ++instance_index) {
+        result.instance_offsets.push_back(instance_index * header->people_count);
+      }
+      return result;
+    }
+
+    result.parse_text(path);
+    return result;
+  }
+
+  //  writes instances that all have people_count people, back to back in times_to_cross, as a binary file
+  static void write_binary(
+    std::string const &path,
+    std::size_t const people_count,
+    std::span<time_to_cross_type const> const times_to_cross
+  ) {
+    ROPE_BRIDGE_TRACE_SPAN("write_binary_instance_file");
+    if (people_count == 0 || times_to_cross.size() % people_count != 0) {
+      throw std::invalid_argument(std::format(
+        "times_to_cross size is out of range. is {}. should be a multiple of people_count {}.",
+        times_to_cross.size(), people_count
+      ));
+    }
+
+    std::ofstream output {path, std::ios::binary | std::ios::trunc};
+    instance_binary_header_type const header {
+      .magic = instance_binary_header_type::binary_magic,
+      .people_count = people_count,
+      .instance_count = times_to_cross.size() / people_count
+    };
+    output.write(reinterpret_cast<char const *>(&header), sizeof(header));
+    output.write(
+      reinterpret_cast<char const *>(times_to_cross.data()), static_cast<std::streamsize>(times_to_cross.size_bytes())
+    );
+
+    if (!output) {
+      throw std::system_error(errno, std::generic_category(), std::format("cannot write {}", path));
+    }
+  }
+
+  [[nodiscard]] std::size_t get_instance_count() const {
+    return instance_offsets.size() - 1;
+  }
+
+  [[nodiscard]] std::span<time_to_cross_type const> get_instance(std::size_t const instance_index) const {
+    auto const offset = instance_offsets.at(instance_index);
+    return times.subspan(offset, instance_offsets.at(instance_index + 1) - offset);
+  }
+
+  private:
+  explicit instance_file_type(mapped_file_type &&file)
+    : file {std::move(file)} {
+  }
+
+  void parse_text(std::string const &path) {
+    auto const bytes = file.get_bytes();
+    auto const first = reinterpret_cast<char const *>(bytes.data());
+    std::size_t line_number = 1;
+
+    //  a time takes at least two bytes with its separator
+    parsed_times.reserve(bytes.size() / 2);
+    instance_offsets.push_back(0);
+    parse_text_instances(
+      path, first, first + bytes.size(), static_cast<std::size_t>(-1), line_number, parsed_times, instance_offsets
+    );
+    times = parsed_times;
+  }
+
+  mapped_file_type file;
+  //  the text format's times, empty for the binary format
+  std::vector<time_to_cross_type> parsed_times;
+  std::span<time_to_cross_type const> times;
+  //  instance i is times[instance_offsets[i], instance_offsets[i + 1])
+  std::vector<std::size_t> instance_offsets;
+};
+
+//  reads a file of either format of instance_file_type chunk by chunk, so only one chunk is parsed
+//  and held at a time
+struct instance_stream_type {
+  static instance_stream_type open(std::string const &path) {
+    instance_stream_type result {path, mapped_file_type::open_read_only(path)};
+    auto const bytes = result.file.get_bytes();
+
+    if (auto const header = instance_binary_header_type::find(path, bytes)) {
+      result.binary_times = header->get_times(bytes);
+      result.binary_people_count = header->people_count;
+    }
+    result.curr = reinterpret_cast<char const *>(bytes.data());
+    return result;
+  }
+
+  //  replaces times and instance_offsets with the next at most max_instance_count instances, laid out as
+  //  in instance_file_type. returns false once every instance has been read.
+  bool read_chunk(
+    std::size_t const max_instance_count,
+    std::vector<time_to_cross_type> &times,
+    std::vector<std::size_t> &instance_offsets
+  ) {
+    ROPE_BRIDGE_TRACE_SPAN("read_instance_chunk");
+    times.clear();
+    instance_offsets.assign(1, 0);
+
+    if (binary_people_count != 0) {
+      auto const chunk_times = binary_times.subspan(
+        0, std::min(binary_times.size(), max_instance_count * binary_people_count)
+      );
+      binary_times = binary_times.subspan(chunk_times.size());
+      times.assign(chunk_times.begin(), chunk_times.end());
+      for (auto offset = binary_people_count; offset <= times.size(); offset += binary_people_count) {
+        instance_offsets.push_back(offset);
+      }
+    } else {
+      auto const bytes = file.get_bytes();
+      curr = parse_text_instances(
+        path, curr, reinterpret_cast<char const *>(bytes.data() + bytes.size()), max_instance_count,
+        line_number, times, instance_offsets
+      );
+    }
+
+    return instance_offsets.size() > 1;
+  }
+
+  private:
+  instance_stream_type(std::string path, mapped_file_type &&file)
+    : path {std::move(path)}, file {std::move(file)} {
+  }
+
+  std::string path;
+  mapped_file_type file;
+  //  the unread times of the binary format
+  std::span<time_to_cross_type const> binary_times;
+  std::size_t binary_people_count = 0;
+  //  where the text format continues
+  char const *curr = nullptr;
+  std::size_t line_number = 1;
+};
@@ -1,291 +1,437 @@
-#include <cassert>
-#include <climits>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <csignal>
 #include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
 #include <format>
-#include <map>
-#include <sstream>
-#include <stdexcept>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
 #include <vector>
 
-using time_to_cross_type = int;
+#include "batch_pipeline.hpp"
+#include "budgeted_state_graph.hpp"
+#include "checkpoint.hpp"
+#include "engine_selection.hpp"
+#include "fixed_people_count.hpp"
+#include "frontier_search.hpp"
+#include "ida_star.hpp"
+#include "instance_file.hpp"
+#include "memory_tracking.hpp"
+#include "query_daemon.hpp"
+#include "query_service.hpp"
+#include "solve_metrics.hpp"
+#include "state_graph.hpp"
+#include "tracing.hpp"
+#include "work_stealing.hpp"
+#include "work_stealing_batch.hpp"
+
+namespace {
+  std::atomic<bool> stop_requested = false;
+
+#ifdef ROPE_BRIDGE_TRACING
+  //  with ROPE_BRIDGE_TRACE_PATH set, writes the spans of the run there as it ends
+  struct trace_file_writer_type {
+    ~trace_file_writer_type() {
+      if (auto const path = std::getenv("ROPE_BRIDGE_TRACE_PATH")) {
+        std::ofstream output {path, std::ios::trunc};
+        trace_registry_type::get().write_chrome_trace(output);
+      }
+    }
+  };
+#endif
+
+#ifdef ROPE_BRIDGE_MEMORY_TRACKING
+  //  with ROPE_BRIDGE_MEMORY_REPORT_PATH set, writes the memory report there as the run ends
+  struct memory_report_writer_type {
+    ~memory_report_writer_type() {
+      if (auto const path = std::getenv("ROPE_BRIDGE_MEMORY_REPORT_PATH")) {
+        std::ofstream output {path, std::ios::trunc};
+        memory_tracker_type::get().write_memory_report(output);
+      }
+    }
+  };
+#endif
 
-struct bridge_state_type {
-  static bridge_state_type start(std::size_t const people_count) {
-    validate_people_count(people_count);
-    return {.state_repr = one_as_int_value_type << (people_count + 1)};
+  //  with ROPE_BRIDGE_METRICS_PATH set, batch runs write their latencies and throughput there as they
+  //  end, and daemons also every metrics_report_interval while they serve
+  auto constexpr metrics_report_interval = std::chrono::seconds {10};
+
+  std::optional<std::string> get_metrics_path() {
+    if (auto const path = std::getenv("ROPE_BRIDGE_METRICS_PATH")) {
+      return path;
+    }
+    return std::nullopt;
+  }
+
+  //  replaces path whole, so readers never see a partial report
+  void write_metrics_report(solve_metrics_collector_type const &metrics, std::string const &path) {
+    auto const partial_path = path + ".partial";
+    {
+      std::ofstream output {partial_path, std::ios::trunc};
+      metrics.write_report(output);
+    }
+    std::filesystem::rename(partial_path, path);
   }
 
-  static bridge_state_type end(std::size_t const people_count) {
-    validate_people_count(people_count);
-    return {.state_repr = (one_as_int_value_type << (people_count + 2)) - 1};
+  //  the whole of arg as a value_type by std::from_chars, as the text instances are parsed, or
+  //  std::nullopt when it is not one, so the modes can answer a bad argument with their usage exit code
+  template <typename value_type>
+  std::optional<value_type> parse_arg(char const *const arg) {
+    std::string_view const text {arg};
+    value_type value;
+    auto const [next, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (error != std::errc {} || next != text.data() + text.size()) {
+      return std::nullopt;
+    }
+    return value;
   }
 
-  static bridge_state_type after_single_crossing(
-    bridge_state_type const &prior_state,
-    std::size_t const crosser_index
+  //  the non-negative times of argv[first_arg_index] onwards, or std::nullopt when one is not
+  std::optional<std::vector<time_to_cross_type>> parse_times_to_cross(
+    int const argc,
+    char **const argv,
+    int const first_arg_index
   ) {
-    validate_crosser_index(prior_state.state_repr, crosser_index);
-    return {
-      .state_repr = prior_state.state_repr
-        ^ torch_bit
-        ^ 1 << crosser_index + 1
-    };
+    std::vector<time_to_cross_type> result;
+    for (auto arg_index = first_arg_index; arg_index < argc; ++arg_index) {
+      auto const time_to_cross = parse_arg<time_to_cross_type>(argv[arg_index]);
+      if (!time_to_cross || *time_to_cross < 0) {
+        return std::nullopt;
+      }
+      result.push_back(*time_to_cross);
+    }
+    return result;
   }
 
-  static bridge_state_type after_double_crossing(
-    bridge_state_type const &prior_state,
-    std::size_t const first_crosser_index,
-    std::size_t const second_crosser_index
-    ) {
-    validate_crosser_index(prior_state.state_repr, first_crosser_index);
-    validate_crosser_index(prior_state.state_repr, second_crosser_index);
-    if (first_crosser_index == second_crosser_index) {
-      throw std::invalid_argument(std::format(
-        "first and second crosser indices are out of range. both are {}. should be distinct.",
-        first_crosser_index
-      ));
+  //  the crosser mask of every crossing of a schedule, each after a space
+  template <typename state_repr_type>
+  std::string format_crosser_masks(std::vector<state_repr_type> const &state_reprs) {
+    std::string result;
+    for (std::size_t step_index = 1; step_index < state_reprs.size(); ++step_index) {
+      result += std::format(" {}", (state_reprs.at(step_index - 1) ^ state_reprs.at(step_index)) >> 1);
     }
-    return {
-      .state_repr = prior_state.state_repr
-        ^ torch_bit
-        ^ 1 << first_crosser_index + 1
-        ^ 1 << second_crosser_index + 1
-    };
+    return result;
   }
 
-  using int_value_type = unsigned int;
-  static auto constexpr int_value_type_bit_count = sizeof(int_value_type) * CHAR_BIT;
+  //  RopeBridge daemon <socket_path> <worker_count> <people_count>…
+  int run_daemon(int const argc, char **const argv) {
+    if (argc < 5) {
+      return 2;
+    }
 
-  [[nodiscard]] int_value_type get_possible_crosser_indices() const {
-    auto const torch_crossed = get_torch_crossed();
-    auto result = state_repr >> 1;
-    auto const people_mask = get_leading_one(result) - 1;
-    result &= people_mask;
-    if (!torch_crossed) {
-      result ^= people_mask;
+    auto const worker_count = parse_arg<std::size_t>(argv[3]);
+    if (!worker_count) {
+      return 2;
     }
 
-    return result;
-  }
+    std::vector<std::size_t> people_counts;
+    for (auto arg_index = 4; arg_index < argc; ++arg_index) {
+      auto const people_count = parse_arg<std::size_t>(argv[arg_index]);
+      if (!people_count) {
+        return 2;
+      }
+      people_counts.push_back(*people_count);
+    }
 
-  static auto constexpr min_people = 1;
-  static auto constexpr max_people = int_value_type_bit_count - 2;
+    auto daemon = query_daemon_type::listen(
+      argv[2], query_service_type::preload(people_counts), *worker_count
+    );
 
-  //  state_repr has the bitwise form 00…001pp…ppt
-  //  unused bits are on the high end and have the form 00..001 or in a special case just a leading 1
-  //  p bits represent whether a given person has crossed the bridge, 0: before the bridge, 1: after
-  //    the expected index of a given person is offset by 1 due to the torch bit
-  //  the t bit represents the side of the torch
-  int_value_type state_repr;
+    std::signal(SIGINT, [](int) { stop_requested.store(true); });
+    std::signal(SIGTERM, [](int) { stop_requested.store(true); });
 
-  struct crossing_type {
-    std::size_t state_index_after_crossing;
-    time_to_cross_type time_to_cross;
-  };
-  std::vector<crossing_type> possible_crossings;
-
-  private:
-  static void validate_people_count(std::size_t const people_count) {
-    if (people_count < min_people || people_count > max_people) {
-      throw std::invalid_argument(std::format(
-        "people_count is out of range. is {}. should be in range [{}, {}].",
-        people_count, min_people, max_people
-      ));
+    auto const metrics_path = get_metrics_path();
+    if (!metrics_path) {
+      daemon.serve(stop_requested);
+      return 0;
     }
-  }
 
-  static void validate_crosser_index(int_value_type const state_repr, std::size_t const crosser_index) {
-    if (
-      auto const leading_one_pos = get_leading_one_pos(state_repr);
-      crosser_index >= leading_one_pos - 1
-    ) {
-      throw std::invalid_argument(std::format(
-        "crosser_index is out of range. is {}. should be in range [{}, {}].",
-        crosser_index, 0, leading_one_pos - 1
-      ));
+    solve_metrics_collector_type metrics;
+    {
+      std::jthread const reporter {[&] {
+        auto next_report = std::chrono::steady_clock::now() + metrics_report_interval;
+        while (!stop_requested.load()) {
+          std::this_thread::sleep_for(std::chrono::milliseconds {100});
+          if (std::chrono::steady_clock::now() >= next_report) {
+            write_metrics_report(metrics, *metrics_path);
+            next_report += metrics_report_interval;
+          }
+        }
+      }};
+      daemon.serve(stop_requested, &metrics);
     }
-  }
+    write_metrics_report(metrics, *metrics_path);
 
-  [[nodiscard]] bool get_torch_crossed() const {
-    return (state_repr & 1) == 1;
+    return 0;
   }
 
-  static int_value_type get_leading_one(int_value_type const state_repr) {
-    return one_as_int_value_type << get_leading_one_pos(state_repr);
-  }
+  //  RopeBridge batch <input_path> <output_path> <solver_count>
+  int run_batch(int const argc, char **const argv) {
+    auto const solver_count = argc == 5 ? parse_arg<std::size_t>(argv[4]) : std::nullopt;
+    if (!solver_count) {
+      return 2;
+    }
+
+    auto input = instance_stream_type::open(argv[2]);
+    std::ofstream output {argv[3], std::ios::binary | std::ios::trunc};
+    auto const metrics_path = get_metrics_path();
+    solve_metrics_collector_type metrics;
 
-  static std::size_t get_leading_one_pos(int_value_type const state_repr) {
-    return int_value_type_bit_count - 1 - __builtin_clz(state_repr);
+    run_batch_pipeline(
+      input,
+      [&](std::string_view const formatted) {
+        output.write(formatted.data(), static_cast<std::streamsize>(formatted.size()));
+      },
+      {
+        .solver_count = *solver_count,
+        .chunk_instance_count = 1024,
+        .chunk_count = 4 * *solver_count,
+        .metrics = metrics_path ? &metrics : nullptr
+      }
+    );
+
+    if (metrics_path) {
+      write_metrics_report(metrics, *metrics_path);
+    }
+    return output ? 0 : 1;
   }
 
-  static auto constexpr one_as_int_value_type = static_cast<int_value_type>(1);
-  static auto constexpr torch_bit = one_as_int_value_type;
+  //  RopeBridge batch-stealing <input_path> <output_path> <worker_count>
+  //  for batches mixing small and large people counts
+  int run_batch_stealing(int const argc, char **const argv) {
+    auto const worker_count = argc == 5 ? parse_arg<std::size_t>(argv[4]) : std::nullopt;
+    if (!worker_count) {
+      return 2;
+    }
 
-  friend std::string as_bits(bridge_state_type const &state);
-};
+    auto const instances = instance_file_type::open(argv[2]);
+    work_stealing_scheduler_type scheduler {*worker_count};
+    auto const metrics_path = get_metrics_path();
+    solve_metrics_collector_type metrics;
 
-std::string as_bits(bridge_state_type const &state) {
-  auto const leading_one_pos = bridge_state_type::get_leading_one_pos(state.state_repr);
+    auto const schedules = solve_batch_work_stealing(
+      instances,
+      scheduler,
+      {
+        .min_split_people_count = 16,
+        .group_cost = get_estimated_solve_cost(10),
+        .metrics = metrics_path ? &metrics : nullptr
+      }
+    );
+    if (metrics_path) {
+      write_metrics_report(metrics, *metrics_path);
+    }
 
-  std::ostringstream result;
-  for (auto bit = bridge_state_type::one_as_int_value_type << leading_one_pos - 1; bit != 1; bit >>= 1) {
-    result << (state.state_repr & bit? "1" : "0");
+    std::string formatted;
+    for (auto const &schedule : schedules) {
+      format_schedule(schedule, formatted);
+    }
+    std::ofstream output {argv[3], std::ios::binary | std::ios::trunc};
+    output.write(formatted.data(), static_cast<std::streamsize>(formatted.size()));
+
+    return output ? 0 : 1;
   }
-  result << " ";
-  result << (state.state_repr & 1? "1" : "0");
 
-  return result.str();
-}
+  //  RopeBridge auto <total_time|schedule|state_graph> <time_to_cross>…
+  //  prints the chosen engine and its thread count, then the total time and, unless only the total time
+  //  was asked for, the crosser mask of every crossing. the engines are calibrated once and the result
+  //  kept at ROPE_BRIDGE_CALIBRATION_PATH, or rope_bridge_calibration in the working directory; the total
+  //  time alone needs no calibration.
+  int run_auto(int const argc, char **const argv) {
+    if (argc < 3) {
+      return 2;
+    }
+
+    std::string_view const output_name {argv[2]};
+    auto const output = output_name == "total_time" ? solve_output_type::total_time
+      : output_name == "schedule" ? solve_output_type::schedule
+      : output_name == "state_graph" ? solve_output_type::state_graph
+      : std::optional<solve_output_type> {};
+    if (!output) {
+      return 2;
+    }
 
-using states_list_type = std::vector<bridge_state_type>;
-using state_to_index_map_type = std::map<bridge_state_type::int_value_type, std::size_t>;
-
-void try_add_or_connect_crossed_state(
-  states_list_type &states,
-  state_to_index_map_type &state_to_states_index,
-  std::size_t &connection_count,
-  std::size_t const curr_state_index,
-  bridge_state_type &&crossed_state,
-  time_to_cross_type const time_to_cross
-) {
-  auto create_connection = false;
-  auto const crossed_state_index_iter = state_to_states_index.find(crossed_state.state_repr);
-  std::size_t crossed_state_index;
-
-  if (crossed_state_index_iter == state_to_states_index.end()) {
-    create_connection = true;
-    crossed_state_index = states.size();
-    state_to_states_index.insert_or_assign(crossed_state.state_repr, crossed_state_index);
-    states.emplace_back(std::move(crossed_state));
-  } else if (crossed_state_index_iter->second > curr_state_index) {
-    create_connection = true;
-    crossed_state_index = crossed_state_index_iter->second;
+    auto const times_to_cross = parse_times_to_cross(argc, argv, 3);
+    if (!times_to_cross) {
+      return 2;
+    }
+
+    auto const calibration_path = std::getenv("ROPE_BRIDGE_CALIBRATION_PATH");
+    auto const calibration = *output == solve_output_type::total_time
+      ? engine_calibration_type {
+          .implicit_ns_per_cost = 0,
+          .materialized_ns_per_cost = 0,
+          .delta_stepping_ns_per_cost = 0,
+          .worker_count = 0
+        }
+      : engine_calibration_type::load_or_measure(
+          calibration_path ? calibration_path : "rope_bridge_calibration",
+          std::max(1u, std::thread::hardware_concurrency())
+        );
+    auto const solution = solve_auto(*times_to_cross, *output, get_available_memory_bytes(), calibration);
+
+    std::cout << std::format(
+      "{} {}\n{}{}\n",
+      get_solve_engine_name(solution.choice.engine), solution.choice.thread_count, solution.total_time,
+      format_crosser_masks(solution.state_reprs)
+    );
+
+    return 0;
   }
 
-  if (!create_connection) {
-    return;
+  //  RopeBridge graph <memory_budget_bytes> <time_to_cross>…
+  //  builds the state graph in the most stored representation that fits the budget and prints it with
+  //  its estimated bytes in memory and in a file, then the total time and the crosser mask of every
+  //  crossing. the graph may only go to a file when ROPE_BRIDGE_EXTERNAL_GRAPH_PATH names a path with no
+  //  file yet.
+  int run_graph(int const argc, char **const argv) {
+    if (argc < 3) {
+      return 2;
+    }
+
+    auto const memory_bytes = parse_arg<std::uint64_t>(argv[2]);
+    auto const times_to_cross = parse_times_to_cross(argc, argv, 3);
+    if (!memory_bytes || !times_to_cross) {
+      return 2;
+    }
+
+    auto const external_path = std::getenv("ROPE_BRIDGE_EXTERNAL_GRAPH_PATH");
+    auto const graph = build_budgeted_state_graph(
+      *times_to_cross,
+      {.memory_bytes = *memory_bytes, .external_path = external_path ? external_path : ""}
+    );
+    auto const schedule = graph.solve();
+
+    std::cout << std::format(
+      "{} {} {}\n{}{}\n",
+      get_state_graph_representation_name(graph.plan.representation), graph.plan.estimated_bytes,
+      graph.plan.external_bytes, schedule.total_time, format_crosser_masks(schedule.state_reprs)
+    );
+
+    return 0;
   }
 
-  ++connection_count;
-  states.at(curr_state_index).possible_crossings.emplace_back(
-    bridge_state_type::crossing_type {
-      .state_index_after_crossing = crossed_state_index,
-      .time_to_cross = time_to_cross
+  //  RopeBridge checkpointed [--resume] <checkpoint_path> <interval_seconds> <time_to_cross>…
+  //  solves with solve_checkpointed and prints the total time and the crosser mask of every crossing.
+  //  with --resume it continues from the checkpoint at checkpoint_path, which is removed once solved.
+  int run_checkpointed(int const argc, char **const argv) {
+    auto arg_index = 2;
+    auto const resume = argc > arg_index && std::string_view {argv[arg_index]} == "--resume";
+    if (resume) {
+      ++arg_index;
     }
-  );
-  states.at(crossed_state_index).possible_crossings.emplace_back(
-    bridge_state_type::crossing_type {
-      .state_index_after_crossing = curr_state_index,
-      .time_to_cross = time_to_cross
+    if (argc < arg_index + 2) {
+      return 2;
     }
-  );
-}
 
-int main() {
-  std::vector<time_to_cross_type> const times_to_cross = {1,10,100,1000};
+    auto const interval_seconds = parse_arg<double>(argv[arg_index + 1]);
+    auto const times_to_cross = parse_times_to_cross(argc, argv, arg_index + 2);
+    if (!interval_seconds || !std::isfinite(*interval_seconds) || *interval_seconds < 0 || !times_to_cross) {
+      return 2;
+    }
 
-  auto const people_count = times_to_cross.size();
-  auto const max_possible_states = (1 << people_count + 1) - 2;
+    checkpoint_options_type const options {
+      .path = argv[arg_index],
+      .interval = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::duration<double> {*interval_seconds}
+      ),
+      .resume = resume
+    };
 
-  states_list_type states;
-  states.reserve(max_possible_states);
+    auto const schedule = solve_checkpointed(*times_to_cross, options);
+    std::filesystem::remove(options.path);
 
-  {
-    state_to_index_map_type state_to_states_index;
+    std::cout << std::format("{}{}\n", schedule.total_time, format_crosser_masks(schedule.state_reprs));
 
-    {
-      auto start_state = bridge_state_type::start(people_count);
-      state_to_states_index.insert_or_assign(start_state.state_repr, states.size());
-      states.emplace_back(std::move(start_state));
+    return 0;
+  }
 
-      auto end_state = bridge_state_type::end(people_count);
-      state_to_states_index.insert_or_assign(end_state.state_repr, states.size());
-      states.emplace_back(std::move(end_state));
+  //  RopeBridge ida <time_to_cross>…
+  //  solves with solve_ida_star, for up to 62 people with few distinct times, and prints the rounds and
+  //  states it expanded, then the total time and the crosser mask of every crossing.
+  int run_ida(int const argc, char **const argv) {
+    auto const times_to_cross = parse_times_to_cross(argc, argv, 2);
+    if (!times_to_cross) {
+      return 2;
     }
 
-    std::size_t connection_count = 0;
+    auto const schedule = solve_ida_star(*times_to_cross);
 
-    for (
-      decltype(states)::size_type curr_state_index = 0;
-      curr_state_index < states.size();
-      ++curr_state_index
-    ) {
-      auto const curr_state_copy = states.at(curr_state_index);
-      auto const possible_crosser_indices =  curr_state_copy.get_possible_crosser_indices();
+    std::cout << std::format(
+      "{} {}\n{}{}\n",
+      schedule.iteration_count, schedule.expanded_count, schedule.total_time, format_crosser_masks(schedule.state_reprs)
+    );
 
-      // iterate single crosser
-      {
-        std::size_t single_crosser_index = 0;
-
-        for (
-          auto iterated_possible_crosser_indices = possible_crosser_indices;
-          iterated_possible_crosser_indices != 0;
-          ++single_crosser_index, iterated_possible_crosser_indices >>= 1
-        ) {
-          if ((iterated_possible_crosser_indices & 1) == 0) {
-            continue;
-          }
+    return 0;
+  }
+
+  //  RopeBridge frontier <time_to_cross>…
+  //  solves with solve_frontier_search, for up to 62 people with few distinct times, and prints the
+  //  largest layer, the searches run and the states they expanded, then the total time and the crosser
+  //  mask of every crossing.
+  int run_frontier(int const argc, char **const argv) {
+    auto const times_to_cross = parse_times_to_cross(argc, argv, 2);
+    if (!times_to_cross) {
+      return 2;
+    }
 
-          assert(single_crosser_index < people_count);
+    auto const schedule = solve_frontier_search(*times_to_cross);
 
-          try_add_or_connect_crossed_state(
-            states,
-            state_to_states_index,
-            connection_count,
-            curr_state_index,
-            bridge_state_type::after_single_crossing(curr_state_copy, single_crosser_index),
-            times_to_cross.at(single_crosser_index)
-          );
-        }
-      }
+    std::cout << std::format(
+      "{} {} {}\n{}{}\n",
+      schedule.max_layer_size, schedule.search_count, schedule.expanded_count, schedule.total_time,
+      format_crosser_masks(schedule.state_reprs)
+    );
 
-      // iterate double crossers
-      {
-        std::size_t first_crosser_index = 0;
-
-        for (
-          auto first_crosser_iterated_possible_crosser_indices = possible_crosser_indices;
-          first_crosser_iterated_possible_crosser_indices != 0;
-          ++first_crosser_index, first_crosser_iterated_possible_crosser_indices >>= 1
-        ) {
-          if ((first_crosser_iterated_possible_crosser_indices & 1) == 0) {
-            continue;
-          }
+    return 0;
+  }
+}
 
-          assert(first_crosser_index < people_count);
-
-          auto second_crosser_index = first_crosser_index + 1;
-
-          for (
-            auto second_crosser_iterated_possible_crosser_indices
-              = first_crosser_iterated_possible_crosser_indices >> 1;
-            second_crosser_iterated_possible_crosser_indices != 0;
-            ++second_crosser_index, second_crosser_iterated_possible_crosser_indices >>= 1
-          ) {
-            if ((second_crosser_iterated_possible_crosser_indices & 1) == 0) {
-              continue;
-            }
-
-            assert(second_crosser_index < people_count);
-
-            try_add_or_connect_crossed_state(
-              states,
-              state_to_states_index,
-              connection_count,
-              curr_state_index,
-              bridge_state_type::after_double_crossing(
-                curr_state_copy, first_crosser_index, second_crosser_index
-              ),
-              std::max(
-                times_to_cross.at(first_crosser_index),
-                times_to_cross.at(second_crosser_index)
-              )
-            );
-          }
-        }
-      }
-    }
+int main(int const argc, char **const argv) {
+#ifdef ROPE_BRIDGE_TRACING
+  trace_file_writer_type const trace_file_writer;
+#endif
+#ifdef ROPE_BRIDGE_MEMORY_TRACKING
+  memory_report_writer_type const memory_report_writer;
+#endif
+
+  if (argc > 1 && std::string_view {argv[1]} == "daemon") {
+    return run_daemon(argc, argv);
+  }
+  if (argc > 1 && std::string_view {argv[1]} == "batch") {
+    return run_batch(argc, argv);
+  }
+  if (argc > 1 && std::string_view {argv[1]} == "batch-stealing") {
+    return run_batch_stealing(argc, argv);
+  }
+  if (argc > 1 && std::string_view {argv[1]} == "auto") {
+    return run_auto(argc, argv);
+  }
+  if (argc > 1 && std::string_view {argv[1]} == "graph") {
+    return run_graph(argc, argv);
+  }
+  if (argc > 1 && std::string_view {argv[1]} == "checkpointed") {
+    return run_checkpointed(argc, argv);
   }
+  if (argc > 1 && std::string_view {argv[1]} == "ida") {
+    return run_ida(argc, argv);
+  }
+  if (argc > 1 && std::string_view {argv[1]} == "frontier") {
+    return run_frontier(argc, argv);
+  }
+
+  std::vector<time_to_cross_type> const times_to_cross = {1,10,100,1000};
+
+  auto const states = build_fixed_state_graph(times_to_cross);
 
   return 0;
 }
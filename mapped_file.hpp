@@ -0,0 +1,161 @@
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <format>
+#include <span>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+//  a whole file mapped into memory, unmapped on destruction
+struct mapped_file_type {
+  static mapped_file_type open_read_only(std::string const &path) {
+    auto const file_descriptor = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (file_descriptor == -1) {
+      throw std::system_error(errno, std::generic_category(), std::format("cannot open {}", path));
+    }
+
+    struct stat file_status {};
+    if (::fstat(file_descriptor, &file_status) == -1) {
+      auto const error = errno;
+      ::close(file_descriptor);
+      throw std::system_error(error, std::generic_category(), std::format("cannot stat {}", path));
+    }
+
+    mapped_file_type result;
+    result.size = static_cast<std::size_t>(file_status.st_size);
+
+    //  an empty file cannot be mapped and needs no mapping
+    if (result.size != 0) {
+      auto const address = ::mmap(nullptr, result.size, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+      if (address == MAP_FAILED) {
+        auto const error = errno;
+        ::close(file_descriptor);
+        throw std::system_error(error, std::generic_category(), std::format("cannot map {}", path));
+      }
+      result.address = address;
+      ::madvise(result.address, result.size, MADV_SEQUENTIAL);
+    }
+
+    ::close(file_descriptor);
+    return result;
+  }
+
+  //  maps path shared and writable, creating it zero filled with size bytes if it is missing or empty
+  static mapped_file_type open_or_create(std::string const &path, std::size_t const size) {
+    auto const file_descriptor = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (file_descriptor == -1) {
+      throw std::system_error(errno, std::generic_category(), std::format("cannot open {}", path));
+    }
+
+    struct stat file_status {};
+    if (::fstat(file_descriptor, &file_status) == -1) {
+      auto const error = errno;
+      ::close(file_descriptor);
+      throw std::system_error(error, std::generic_category(), std::format("cannot stat {}", path));
+    }
+
+    mapped_file_type result;
+    result.size = static_cast<std::size_t>(file_status.st_size);
+    result.writable = true;
+
+    if (result.size == 0) {
+      if (::ftruncate(file_descriptor, static_cast<off_t>(size)) == -1) {
+        auto const error = errno;
+        ::close(file_descriptor);
+        throw std::system_error(error, std::generic_category(), std::format("cannot resize {}", path));
+      }
+      result.size = size;
+    }
+
+    auto const address = ::mmap(nullptr, result.size, PROT_READ | PROT_WRITE, MAP_SHARED, file_descriptor, 0);
+    if (address == MAP_FAILED) {
+      auto const error = errno;
+      ::close(file_descriptor);
+      throw std::system_error(error, std::generic_category(), std::format("cannot map {}", path));
+    }
+    result.address = address;
+
+    ::close(file_descriptor);
+    return result;
+  }
+
+  //  maps a new zero filled file of size bytes at path shared and writable, failing rather than
+  //  replacing a file already there. the file is unlinked at once, so it goes with the mapping.
+  static mapped_file_type create_scratch(std::string const &path, std::size_t const size) {
+    auto const file_descriptor = ::open(path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+    if (file_descriptor == -1) {
+      throw std::system_error(errno, std::generic_category(), std::format("cannot create {}", path));
+    }
+    ::unlink(path.c_str());
+
+    if (::ftruncate(file_descriptor, static_cast<off_t>(size)) == -1) {
+      auto const error = errno;
+      ::close(file_descriptor);
+      throw std::system_error(error, std::generic_category(), std::format("cannot resize {}", path));
+    }
+
+    auto const address = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, file_descriptor, 0);
+    if (address == MAP_FAILED) {
+      auto const error = errno;
+      ::close(file_descriptor);
+      throw std::system_error(error, std::generic_category(), std::format("cannot map {}", path));
+    }
+
+    mapped_file_type result;
+    result.address = address;
+    result.size = size;
+    result.writable = true;
+
+    ::close(file_descriptor);
+    return result;
+  }
+
+  mapped_file_type(mapped_file_type &&other) noexcept
+    : address {std::exchange(other.address, nullptr)},
+      size {std::exchange(other.size, 0)},
+      writable {std::exchange(other.writable, false)} {
+  }
+
+  mapped_file_type &operator=(mapped_file_type &&other) noexcept {
+    std::swap(address, other.address);
+    std::swap(size, other.size);
+    std::swap(writable, other.writable);
+    return *this;
+  }
+
+  mapped_file_type(mapped_file_type const &) = delete;
+  mapped_file_type &operator=(mapped_file_type const &) = delete;
+
+  ~mapped_file_type() {
+    if (address != nullptr) {
+      ::munmap(address, size);
+    }
+  }
+
+  //  page aligned, so any trivially copyable type can be read in place at aligned offsets
+  [[nodiscard]] std::span<std::byte const> get_bytes() const {
+    return {static_cast<std::byte const *>(address), size};
+  }
+
+  //  empty unless opened by open_or_create or create_scratch
+  [[nodiscard]] std::span<std::byte> get_writable_bytes() const {
+    if (!writable) {
+      return {};
+    }
+    return {static_cast<std::byte *>(address), size};
+  }
+
+  private:
+  mapped_file_type() = default;
+
+  void *address = nullptr;
+  std::size_t size = 0;
+  bool writable = false;
+};
@@ -0,0 +1,181 @@
+#pragma once
+
+//  bytes and allocations per data structure category, for finding what caps the people count.
+//
+//  the containers of each category use tracked_allocator_type, which is std::allocator unless
+//  ROPE_BRIDGE_MEMORY_TRACKING is defined, as the CMake option of the same name does. with it defined,
+//  every allocation updates the current and peak bytes of its category in memory_tracker_type, which
+//  write_memory_report writes as JSON.
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#ifdef ROPE_BRIDGE_MEMORY_TRACKING
+#include <atomic>
+#include <ostream>
+#endif
+
+enum class memory_category_type {
+  //  states_list_type
+  states,
+  //  bridge_state_type::possible_crossings
+  possible_crossings,
+  //  state_to_index_map_type
+  state_index_map,
+  //  distances, predecessors and frontiers of the solvers
+  solver_scratch,
+  //  csr_state_graph_type held in memory
+  csr_graph
+};
+
+auto constexpr memory_category_count = std::size_t {5};
+
+inline std::string_view get_memory_category_name(memory_category_type const category) {
+  static constexpr std::array<std::string_view, memory_category_count> names {
+    "states", "possible_crossings", "state_index_map", "solver_scratch", "csr_graph"
+  };
+  return names.at(static_cast<std::size_t>(category));
+}
+
+#ifdef ROPE_BRIDGE_MEMORY_TRACKING
+
+struct memory_usage_type {
+  std::size_t current_bytes;
+  std::size_t peak_bytes;
+  std::size_t allocation_count;
+  std::size_t deallocation_count;
+};
+
+struct memory_tracker_type {
+  static memory_tracker_type &get() {
+    static memory_tracker_type tracker;
+    return tracker;
+  }
+
+  void record_allocation(memory_category_type const category, std::size_t const byte_count) {
+    auto &counters = category_counters.at(static_cast<std::size_t>(category));
+    counters.record_allocation(byte_count);
+    total_counters.record_allocation(byte_count);
+  }
+
+  void record_deallocation(memory_category_type const category, std::size_t const byte_count) {
+    auto &counters = category_counters.at(static_cast<std::size_t>(category));
+    counters.record_deallocation(byte_count);
+    total_counters.record_deallocation(byte_count);
+  }
+
+  [[nodiscard]] memory_usage_type get_usage(memory_category_type const category) const {
+    return category_counters.at(static_cast<std::size_t>(category)).get_usage();
+  }
+
+  //  the peak is of the sum over the categories, not the sum of their peaks
+  [[nodiscard]] memory_usage_type get_total_usage() const {
+    return total_counters.get_usage();
+  }
+
+  void write_memory_report(std::ostream &output) const {
+    auto const write_usage = [&](memory_usage_type const &usage) {
+      output << "{\"current_bytes\":" << usage.current_bytes
+        << ",\"peak_bytes\":" << usage.peak_bytes
+        << ",\"allocation_count\":" << usage.allocation_count
+        << ",\"deallocation_count\":" << usage.deallocation_count << '}';
+    };
+
+    output << "{\"categories\":{";
+    for (std::size_t category_index = 0; category_index < memory_category_count; ++category_index) {
+      auto const category = static_cast<memory_category_type>(category_index);
+      output << (category_index == 0 ? "\n" : ",\n") << '"' << get_memory_category_name(category) << "\":";
+      write_usage(get_usage(category));
+    }
+    output << "\n},\"total\":";
+    write_usage(get_total_usage());
+    output << "}\n";
+  }
+
+  private:
+  struct counters_type {
+    void record_allocation(std::size_t const byte_count) {
+      allocation_count.fetch_add(1, std::memory_order_relaxed);
+      auto const bytes = current_bytes.fetch_add(byte_count, std::memory_order_relaxed) + byte_count;
+      for (auto prior_peak = peak_bytes.load(std::memory_order_relaxed); prior_peak < bytes;) {
+        if (peak_bytes.compare_exchange_weak(prior_peak, bytes, std::memory_order_relaxed)) {
+          break;
+        }
+      }
+    }
+
+    void record_deallocation(std::size_t const byte_count) {
+      deallocation_count.fetch_add(1, std::memory_order_relaxed);
+      current_bytes.fetch_sub(byte_count, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] memory_usage_type get_usage() const {
+      return {
+        .current_bytes = current_bytes.load(std::memory_order_relaxed),
+        .peak_bytes = peak_bytes.load(std::memory_order_relaxed),
+        .allocation_count = allocation_count.load(std::memory_order_relaxed),
+        .deallocation_count = deallocation_count.load(std::memory_order_relaxed)
+      };
+    }
+
+    std::atomic<std::size_t> current_bytes = 0;
+    std::atomic<std::size_t> peak_bytes = 0;
+    std::atomic<std::size_t> allocation_count = 0;
+    std::atomic<std::size_t> deallocation_count = 0;
+  };
+
+  memory_tracker_type() = default;
+
+  std::array<counters_type, memory_category_count> category_counters;
+  counters_type total_counters;
+};
+
+//  std::allocator that records into memory_tracker_type under category. stateless, so containers of
+//  one category compare, move and swap as with std::allocator.
+template <typename allocated_type, memory_category_type category>
+struct tracking_allocator_type {
+  using value_type = allocated_type;
+
+  template <typename rebound_type>
+  struct rebind {
+    using other = tracking_allocator_type<rebound_type, category>;
+  };
+
+  tracking_allocator_type() = default;
+
+  template <typename other_type>
+  explicit(false) tracking_allocator_type(tracking_allocator_type<other_type, category> const &) {
+  }
+
+  allocated_type *allocate(std::size_t const count) {
+    auto const allocated = std::allocator<allocated_type> {}.allocate(count);
+    memory_tracker_type::get().record_allocation(category, count * sizeof(allocated_type));
+    return allocated;
+  }
+
+  void deallocate(allocated_type *const allocated, std::size_t const count) {
+    memory_tracker_type::get().record_deallocation(category, count * sizeof(allocated_type));
+    std::allocator<allocated_type> {}.deallocate(allocated, count);
+  }
+
+  template <typename other_type>
+  bool operator==(tracking_allocator_type<other_type, category> const &) const {
+    return true;
+  }
+};
+
+template <typename allocated_type, memory_category_type category>
+using tracked_allocator_type = tracking_allocator_type<allocated_type, category>;
+
+#else
+
+template <typename allocated_type, memory_category_type>
+using tracked_allocator_type = std::allocator<allocated_type>;
+
+#endif
+
+template <typename element_type, memory_category_type category>
+using tracked_vector_type = std::vector<element_type, tracked_allocator_type<element_type, category>>;
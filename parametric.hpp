@@ -0,0 +1,274 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "bridge_state.hpp"
+#include "shortest_path.hpp"
+#include "state_graph.hpp"
+
+//  crossing times with one person's time replaced by numerator / denominator, scaled by denominator so
+//  every path length stays an exact integer
+struct parametric_crossing_cost_type {
+  std::int64_t operator()(std::size_t const curr_state_index, bridge_state_type::crossing_type const &crossing) const {
+    auto const crossers = (states.at(curr_state_index).state_repr
+      ^ states.at(crossing.state_index_after_crossing).state_repr) >> 1;
+
+    std::int64_t result = 0;
+    std::size_t crosser_index = 0;
+    for (auto iterated_crossers = crossers; iterated_crossers != 0; ++crosser_index, iterated_crossers >>= 1) {
+      if ((iterated_crossers & 1) == 0) {
+        continue;
+      }
+      result = std::max(
+        result,
+        crosser_index == person_index ? numerator : times_to_cross.at(crosser_index) * denominator
+      );
+    }
+
+    return result;
+  }
+
+  states_list_type const &states;
+  std::vector<time_to_cross_type> const &times_to_cross;
+  std::size_t person_index;
+  std::int64_t numerator;
+  std::int64_t denominator;
+};
+
+//  the slowest time among the crossers other than person_index, 0 if they cross alone
+inline time_to_cross_type get_other_crossers_time(
+  std::vector<time_to_cross_type> const &times_to_cross,
+  bridge_state_type::int_value_type const crossers,
+  std::size_t const person_index
+) {
+  time_to_cross_type other_time = 0;
+  std::size_t crosser_index = 0;
+  for (auto iterated_crossers = crossers; iterated_crossers != 0; ++crosser_index, iterated_crossers >>= 1) {
+    if ((iterated_crossers & 1) == 1 && crosser_index != person_index) {
+      other_time = std::max(other_time, times_to_cross.at(crosser_index));
+    }
+  }
+  return other_time;
+}
+
+//  the slope of the path's length in the time of person_index just above lower_time, which is the count
+//  of its crossings that person_index leads there
+inline std::int64_t get_parametric_path_slope(
+  states_list_type const &states,
+  std::vector<time_to_cross_type> const &times_to_cross,
+  std::vector<std::size_t> const &state_indices,
+  std::size_t const person_index,
+  std::int64_t const lower_time
+) {
+  std::int64_t slope = 0;
+  for (std::size_t step_index = 1; step_index < state_indices.size(); ++step_index) {
+    auto const crossers = (states.at(state_indices.at(step_index - 1)).state_repr
+      ^ states.at(state_indices.at(step_index)).state_repr) >> 1;
+    if ((crossers >> person_index & 1) == 1 && get_other_crossers_time(times_to_cross, crossers, person_index) <= lower_time) {
+      ++slope;
+    }
+  }
+  return slope;
+}
+
+//  the path's length scaled by denominator with person_index crossing in numerator / denominator
+inline std::int64_t get_parametric_path_length(
+  states_list_type const &states,
+  std::vector<time_to_cross_type> const &times_to_cross,
+  std::vector<std::size_t> const &state_indices,
+  std::size_t const person_index,
+  std::int64_t const numerator,
+  std::int64_t const denominator
+) {
+  parametric_crossing_cost_type const crossing_cost {states, times_to_cross, person_index, numerator, denominator};
+  std::int64_t length = 0;
+
+  for (std::size_t step_index = 1; step_index < state_indices.size(); ++step_index) {
+    auto const from_state_index = state_indices.at(step_index - 1);
+    auto const &possible_crossings = states.at(from_state_index).possible_crossings;
+    auto const crossing = std::ranges::find(
+      possible_crossings, state_indices.at(step_index), &bridge_state_type::crossing_type::state_index_after_crossing
+    );
+    if (crossing == possible_crossings.end()) {
+      throw std::logic_error(std::format(
+        "state_indices holds no crossing from state {} to state {}", from_state_index, state_indices.at(step_index)
+      ));
+    }
+    length += crossing_cost(from_state_index, *crossing);
+  }
+
+  return length;
+}
+
+struct optimum_curve_breakpoint_type {
+  double time_to_cross;
+  double total_time;
+  //  of the optimum from this breakpoint to the next. the last breakpoint closes the range and repeats
+  //  the slope of the last piece.
+  std::int64_t slope;
+};
+
+//  the shortest path with person_index crossing in numerator / denominator, its total time scaled by
+//  denominator
+inline auto solve_parametric_shortest_path(
+  states_list_type const &states,
+  std::vector<time_to_cross_type> const &times_to_cross,
+  std::size_t const person_index,
+  std::int64_t const numerator,
+  std::int64_t const denominator
+) {
+  return solve_shortest_path(
+    states, parametric_crossing_cost_type {states, times_to_cross, person_index, numerator, denominator}
+  );
+}
+
+//  appends to curve the breakpoints of the optimum in the time of person_index over an interval that
+//  starts at interval_start and holds no other person's time, from paths optimal at both its ends. a
+//  breakpoint repeating the slope of the one before it is left out.
+//
+//  every path length is linear over the interval, so the optimum is the concave lower envelope of the
+//  optimal paths' lines. the optimum at the intersection of two neighbouring lines either lies on both,
+//  which makes it a breakpoint, or comes from a new path whose line splits the search. every Dijkstra
+//  run therefore finds a breakpoint or a new piece of the curve, and times where the optimum stays on
+//  the same line are never solved.
+inline void append_optimum_curve_interval(
+  states_list_type const &states,
+  std::vector<time_to_cross_type> const &times_to_cross,
+  std::size_t const person_index,
+  std::int64_t const interval_start,
+  std::vector<std::size_t> const &start_state_indices,
+  std::vector<std::size_t> const &end_state_indices,
+  std::vector<optimum_curve_breakpoint_type> &curve
+) {
+  //  a path's length over the interval, length_at_start + slope * (time - interval_start)
+  struct line_type {
+    std::int64_t length_at_start;
+    std::int64_t slope;
+  };
+
+  auto const add_breakpoint = [&](
+    std::int64_t const numerator,
+    std::int64_t const denominator,
+    std::int64_t const scaled_total_time,
+    std::int64_t const slope
+  ) {
+    auto const time_to_cross = static_cast<double>(numerator) / static_cast<double>(denominator);
+    //  a path found at an interval start may only tie there, and its piece then has no width
+    if (!curve.empty() && curve.back().time_to_cross == time_to_cross) {
+      curve.pop_back();
+    }
+    if (!curve.empty() && curve.back().slope == slope) {
+      return;
+    }
+    curve.push_back({
+      .time_to_cross = time_to_cross,
+      .total_time = static_cast<double>(scaled_total_time) / static_cast<double>(denominator),
+      .slope = slope
+    });
+  };
+
+  auto const get_path_line = [&](std::vector<std::size_t> const &state_indices) {
+    return line_type {
+      .length_at_start = get_parametric_path_length(states, times_to_cross, state_indices, person_index, interval_start, 1),
+      .slope = get_parametric_path_slope(states, times_to_cross, state_indices, person_index, interval_start)
+    };
+  };
+
+  auto const refine = [&](auto const &self, line_type const &left, line_type const &right) -> void {
+    if (left.slope == right.slope) {
+      return;
+    }
+
+    auto const denominator = left.slope - right.slope;
+    auto const numerator = interval_start * denominator + right.length_at_start - left.length_at_start;
+    auto const scaled_left_length = left.length_at_start * denominator + left.slope * (numerator - interval_start * denominator);
+
+    auto const middle = get_path_line(
+      solve_parametric_shortest_path(states, times_to_cross, person_index, numerator, denominator).state_indices
+    );
+    auto const scaled_middle_length = middle.length_at_start * denominator + middle.slope * (numerator - interval_start * denominator);
+
+    if (scaled_middle_length == scaled_left_length) {
+      add_breakpoint(numerator, denominator, scaled_left_length, right.slope);
+      return;
+    }
+
+    self(self, left, middle);
+    self(self, middle, right);
+  };
+
+  auto const left = get_path_line(start_state_indices);
+  add_breakpoint(interval_start, 1, left.length_at_start, left.slope);
+  refine(refine, left, get_path_line(end_state_indices));
+}
+
+//  the optimum as an exact piecewise-linear function of the time of person_index over
+//  [min_time, max_time], as its breakpoints, by append_optimum_curve_interval between consecutive
+//  times of other people. each interval end is solved once for both intervals it bounds.
+inline std::vector<optimum_curve_breakpoint_type> compute_optimum_curve(
+  states_list_type const &states,
+  std::vector<time_to_cross_type> const &times_to_cross,
+  std::size_t const person_index,
+  time_to_cross_type const min_time,
+  time_to_cross_type const max_time
+) {
+  if (auto const people_count = states.at(start_state_index).get_people_count(); times_to_cross.size() != people_count) {
+    throw std::invalid_argument(std::format(
+      "times_to_cross size is out of range. is {}. should be {}.",
+      times_to_cross.size(), people_count
+    ));
+  }
+  if (person_index >= times_to_cross.size()) {
+    throw std::invalid_argument(std::format(
+      "person_index is out of range. is {}. should be in range [{}, {}].",
+      person_index, 0, times_to_cross.size() - 1
+    ));
+  }
+  if (min_time < 0 || max_time < min_time) {
+    throw std::invalid_argument(std::format(
+      "time range is out of range. is [{}, {}]. should be non-negative and ordered.",
+      min_time, max_time
+    ));
+  }
+
+  std::vector<std::int64_t> interval_ends {min_time, max_time};
+  for (std::size_t other_index = 0; other_index < times_to_cross.size(); ++other_index) {
+    if (auto const other_time = times_to_cross.at(other_index); other_index != person_index && other_time > min_time && other_time < max_time) {
+      interval_ends.push_back(other_time);
+    }
+  }
+  std::ranges::sort(interval_ends);
+  interval_ends.erase(std::ranges::unique(interval_ends).begin(), interval_ends.end());
+
+  std::vector<optimum_curve_breakpoint_type> result;
+
+  auto boundary_path = solve_parametric_shortest_path(states, times_to_cross, person_index, min_time, 1);
+  for (std::size_t interval_index = 0; interval_index + 1 < interval_ends.size(); ++interval_index) {
+    auto next_boundary_path = solve_parametric_shortest_path(
+      states, times_to_cross, person_index, interval_ends.at(interval_index + 1), 1
+    );
+    append_optimum_curve_interval(
+      states, times_to_cross, person_index, interval_ends.at(interval_index),
+      boundary_path.state_indices, next_boundary_path.state_indices, result
+    );
+    boundary_path = std::move(next_boundary_path);
+  }
+
+  if (!result.empty() && result.back().time_to_cross == static_cast<double>(max_time)) {
+    result.pop_back();
+  }
+  auto const closing = boundary_path.total_time;
+  result.push_back({
+    .time_to_cross = static_cast<double>(max_time),
+    .total_time = static_cast<double>(closing),
+    .slope = result.empty() ? 0 : result.back().slope
+  });
+
+  return result;
+}
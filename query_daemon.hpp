@@ -0,0 +1,285 @@
+#pragma once
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstring>
+#include <deque>
+#include <format>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "query_service.hpp"
+#include "solve_metrics.hpp"
+#include "tracing.hpp"
+
+//  serves query_service_type over a Unix domain socket with a pool of worker threads.
+//
+//  the accepting thread hands connections to the workers, and a worker serves one connection until the
+//  client closes it. every read is answered as a batch: all complete requests in it are answered
+//  into one buffer with the worker's scratch and sent with one write, so clients pipelining many
+//  small requests pay one round of system calls per batch instead of per request. a request the service
+//  rejects is answered with its status and the connection goes on, as its length prefix keeps the
+//  stream in step. a length prefix past max_request_word_count is answered as malformed and then closes
+//  the connection, since the stream cannot be resynchronized after it.
+struct query_daemon_type {
+  static query_daemon_type listen(
+    std::string const &socket_path,
+    query_service_type &&service,
+    std::size_t const worker_count
+  ) {
+    if (worker_count == 0) {
+      throw std::invalid_argument("worker_count is out of range. is 0. should be positive.");
+    }
+
+    sockaddr_un address {};
+    address.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(address.sun_path)) {
+      throw std::invalid_argument(std::format(
+        "socket_path size is out of range. is {}. should be less than {}.",
+        socket_path.size(), sizeof(address.sun_path)
+      ));
+    }
+    std::memcpy(address.sun_path, socket_path.c_str(), socket_path.size() + 1);
+
+    auto const listening_descriptor = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listening_descriptor == -1) {
+      throw std::system_error(errno, std::generic_category(), "cannot create socket");
+    }
+
+    //  a socket left by an earlier daemon is replaced, but any other file makes bind fail
+    struct stat file_status {};
+    if (::lstat(socket_path.c_str(), &file_status) == 0 && S_ISSOCK(file_status.st_mode)) {
+      ::unlink(socket_path.c_str());
+    }
+    if (
+      ::bind(listening_descriptor, reinterpret_cast<sockaddr const *>(&address), sizeof(address)) == -1
+        || ::listen(listening_descriptor, SOMAXCONN) == -1
+    ) {
+      auto const error = errno;
+      ::close(listening_descriptor);
+      throw std::system_error(error, std::generic_category(), std::format("cannot listen on {}", socket_path));
+    }
+
+    return query_daemon_type {socket_path, std::move(service), worker_count, listening_descriptor};
+  }
+
+  query_daemon_type(query_daemon_type &&other) noexcept
+    : socket_path {std::move(other.socket_path)},
+      service {std::move(other.service)},
+      worker_count {other.worker_count},
+      listening_descriptor {std::exchange(other.listening_descriptor, -1)} {
+  }
+
+  query_daemon_type(query_daemon_type const &) = delete;
+  query_daemon_type &operator=(query_daemon_type const &) = delete;
+  query_daemon_type &operator=(query_daemon_type &&) = delete;
+
+  ~query_daemon_type() {
+    if (listening_descriptor != -1) {
+      ::close(listening_descriptor);
+      ::unlink(socket_path.c_str());
+    }
+  }
+
+  //  serves until stop_requested is set, which is checked at least every poll_timeout_ms. the latencies
+  //  of answered queries go to metrics once per batch, unless it is nullptr.
+  void serve(std::atomic<bool> const &stop_requested, solve_metrics_collector_type *const metrics = nullptr) {
+    std::vector<std::jthread> workers;
+    workers.reserve(worker_count);
+    for (std::size_t worker_index = 0; worker_index < worker_count; ++worker_index) {
+      workers.emplace_back([&] {
+        run_worker(stop_requested, metrics);
+      });
+    }
+
+    pollfd listening_poll {.fd = listening_descriptor, .events = POLLIN, .revents = 0};
+
+    while (!stop_requested.load()) {
+      if (::poll(&listening_poll, 1, poll_timeout_ms) <= 0) {
+        continue;
+      }
+
+      auto const connection_descriptor = ::accept4(listening_descriptor, nullptr, nullptr, SOCK_CLOEXEC);
+      if (connection_descriptor == -1) {
+        continue;
+      }
+
+      {
+        std::scoped_lock const lock {connections_mutex};
+        pending_connection_descriptors.push_back(connection_descriptor);
+      }
+      connections_available.notify_one();
+    }
+
+    connections_available.notify_all();
+    workers.clear();
+
+    for (auto const connection_descriptor : pending_connection_descriptors) {
+      ::close(connection_descriptor);
+    }
+    pending_connection_descriptors.clear();
+  }
+
+  private:
+  static auto constexpr poll_timeout_ms = 100;
+  static auto constexpr read_buffer_word_count = std::size_t {1} << 14;
+
+  query_daemon_type(
+    std::string socket_path,
+    query_service_type &&service,
+    std::size_t const worker_count,
+    int const listening_descriptor
+  )
+    : socket_path {std::move(socket_path)},
+      service {std::move(service)},
+      worker_count {worker_count},
+      listening_descriptor {listening_descriptor} {
+  }
+
+  void run_worker(std::atomic<bool> const &stop_requested, solve_metrics_collector_type *const metrics) {
+    query_scratch_type scratch;
+    solve_metrics_type batch_metrics;
+
+    while (true) {
+      int connection_descriptor;
+      {
+        std::unique_lock lock {connections_mutex};
+        connections_available.wait_for(lock, std::chrono::milliseconds {poll_timeout_ms}, [&] {
+          return !pending_connection_descriptors.empty() || stop_requested.load();
+        });
+        if (stop_requested.load()) {
+          return;
+        }
+        if (pending_connection_descriptors.empty()) {
+          continue;
+        }
+        connection_descriptor = pending_connection_descriptors.front();
+        pending_connection_descriptors.pop_front();
+      }
+
+      serve_connection(connection_descriptor, scratch, stop_requested, metrics, batch_metrics);
+      ::close(connection_descriptor);
+    }
+  }
+
+  void serve_connection(
+    int const connection_descriptor,
+    query_scratch_type &scratch,
+    std::atomic<bool> const &stop_requested,
+    solve_metrics_collector_type *const metrics,
+    solve_metrics_type &batch_metrics
+  ) const {
+    std::vector<query_word_type> received(read_buffer_word_count);
+    std::size_t received_byte_count = 0;
+    std::vector<query_word_type> responses;
+    pollfd connection_poll {.fd = connection_descriptor, .events = POLLIN, .revents = 0};
+
+    while (!stop_requested.load()) {
+      if (::poll(&connection_poll, 1, poll_timeout_ms) <= 0) {
+        continue;
+      }
+
+      auto const read_byte_count = ::read(
+        connection_descriptor,
+        reinterpret_cast<std::byte *>(received.data()) + received_byte_count,
+        received.size() * sizeof(query_word_type) - received_byte_count
+      );
+      if (read_byte_count <= 0) {
+        return;
+      }
+      received_byte_count += static_cast<std::size_t>(read_byte_count);
+
+      //  answer every complete request of the batch
+      ROPE_BRIDGE_TRACE_SPAN("answer_query_batch");
+      auto const received_word_count = received_byte_count / sizeof(query_word_type);
+      std::size_t word_index = 0;
+      auto malformed = false;
+      responses.clear();
+
+      while (word_index < received_word_count) {
+        auto const request_word_count = std::size_t {received[word_index]};
+        if (request_word_count > query_service_type::max_request_word_count) {
+          malformed = true;
+          responses.push_back(1);
+          responses.push_back(static_cast<query_word_type>(query_status_type::malformed));
+          break;
+        }
+        if (word_index + 1 + request_word_count > received_word_count) {
+          break;
+        }
+
+        auto const request = std::span {received}.subspan(word_index + 1, request_word_count);
+        if (metrics == nullptr) {
+          service.answer(request, scratch, responses);
+        } else {
+          auto const answer_start = std::chrono::steady_clock::now();
+          if (service.answer(request, scratch, responses) == query_status_type::ok) {
+            batch_metrics.record(request[1], get_elapsed_ns(answer_start));
+          }
+        }
+        word_index += 1 + request_word_count;
+      }
+
+      if (metrics != nullptr) {
+        metrics->add(batch_metrics);
+        batch_metrics.clear();
+      }
+
+      if (!send_all(connection_descriptor, responses) || malformed) {
+        return;
+      }
+
+      //  keep the partial request for the next read
+      auto const consumed_byte_count = word_index * sizeof(query_word_type);
+      std::memmove(
+        received.data(),
+        reinterpret_cast<std::byte const *>(received.data()) + consumed_byte_count,
+        received_byte_count - consumed_byte_count
+      );
+      received_byte_count -= consumed_byte_count;
+    }
+  }
+
+  static bool send_all(int const connection_descriptor, std::vector<query_word_type> const &words) {
+    auto const bytes = std::as_bytes(std::span {words});
+
+    for (std::size_t sent_byte_count = 0; sent_byte_count < bytes.size();) {
+      auto const written_byte_count = ::send(
+        connection_descriptor, bytes.data() + sent_byte_count, bytes.size() - sent_byte_count, MSG_NOSIGNAL
+      );
+      if (written_byte_count == -1 && errno == EINTR) {
+        continue;
+      }
+      if (written_byte_count <= 0) {
+        return false;
+      }
+      sent_byte_count += static_cast<std::size_t>(written_byte_count);
+    }
+
+    return true;
+  }
+
+  std::string socket_path;
+  query_service_type service;
+  std::size_t worker_count;
+  int listening_descriptor;
+
+  std::mutex connections_mutex;
+  std::condition_variable connections_available;
+  std::deque<int> pending_connection_descriptors;
+};
@@ -0,0 +1,202 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "bridge_state.hpp"
+#include "fixed_people_count.hpp"
+#include "memory_tracking.hpp"
+#include "shortest_path.hpp"
+#include "state_graph.hpp"
+
+//  the binary protocol of the query daemon. every message is a sequence of native-endian 32-bit words
+//  starting with the count of the words after it.
+//
+//  request: word_count, kind, people_count, times_to_cross…, then by kind
+//    solve: nothing
+//    feasibility: deadline
+//    mid_state: state_repr to continue from
+//  response: word_count, status, then when the status is ok, by kind
+//    solve and mid_state: total_time, state_count, state_repr… up to the end state
+//    feasibility: 1 when the optimum is within the deadline else 0, total_time
+using query_word_type = std::uint32_t;
+
+enum class query_kind_type : query_word_type {
+  solve = 0,
+  feasibility = 1,
+  mid_state = 2
+};
+
+enum class query_status_type : query_word_type {
+  ok = 0,
+  malformed = 1,
+  people_count_not_loaded = 2,
+  unknown_state = 3
+};
+
+//  per-thread buffers reused across queries
+struct query_scratch_type {
+  std::vector<time_to_cross_type> times_to_cross;
+  tracked_vector_type<time_to_cross_type, memory_category_type::solver_scratch> distances;
+  tracked_vector_type<std::size_t, memory_category_type::solver_scratch> predecessors;
+};
+
+//  answers queries over graphs built once per people count. a graph's structure does not depend on
+//  the times, so it is built with zero times and every crossing is weighed by the times of its crossers
+//  when a query relaxes it.
+struct query_service_type {
+  //  longest request a valid query can have, past its word_count
+  static auto constexpr max_request_word_count = std::size_t {2 + bridge_state_type::max_people + 1};
+
+  static query_service_type preload(std::vector<std::size_t> const &people_counts) {
+    query_service_type result;
+    result.graphs_by_people_count.resize(bridge_state_type::max_people + 1);
+
+    for (auto const people_count : people_counts) {
+      //  validates the people count
+      auto const leading_one = bridge_state_type::start(people_count).state_repr;
+
+      structural_graph_type graph {
+        .states = build_fixed_state_graph(std::vector<time_to_cross_type>(people_count, 0)),
+        .state_index_by_repr = std::vector<std::size_t>(leading_one, no_state_index)
+      };
+      for (std::size_t state_index = 0; state_index < graph.states.size(); ++state_index) {
+        graph.state_index_by_repr.at(graph.states.at(state_index).state_repr - leading_one) = state_index;
+      }
+
+      result.graphs_by_people_count.at(people_count) = std::move(graph);
+    }
+
+    return result;
+  }
+
+  //  appends the response to request, given without its word_count, to response, and returns its status
+  query_status_type answer(
+    std::span<query_word_type const> const request,
+    query_scratch_type &scratch,
+    std::vector<query_word_type> &response
+  ) const {
+    auto const word_count_position = response.size();
+    response.push_back(0);
+
+    auto const status = answer_words(request, scratch, response);
+    if (status != query_status_type::ok) {
+      response.resize(word_count_position + 1);
+      response.push_back(static_cast<query_word_type>(status));
+    }
+
+    response.at(word_count_position) = static_cast<query_word_type>(response.size() - word_count_position - 1);
+    return status;
+  }
+
+  private:
+  static auto constexpr no_state_index = static_cast<std::size_t>(-1);
+
+  struct structural_graph_type {
+    states_list_type states;
+    //  indexed by state_repr - leading one
+    std::vector<std::size_t> state_index_by_repr;
+  };
+
+  query_status_type answer_words(
+    std::span<query_word_type const> const request,
+    query_scratch_type &scratch,
+    std::vector<query_word_type> &response
+  ) const {
+    if (request.size() < 2) {
+      return query_status_type::malformed;
+    }
+
+    auto const kind = static_cast<query_kind_type>(request[0]);
+    auto const people_count = std::size_t {request[1]};
+    auto const extra_word_count = kind == query_kind_type::solve ? 0 : 1;
+
+    if (kind > query_kind_type::mid_state || request.size() != 2 + people_count + extra_word_count) {
+      return query_status_type::malformed;
+    }
+    if (people_count >= graphs_by_people_count.size() || !graphs_by_people_count.at(people_count).has_value()) {
+      return query_status_type::people_count_not_loaded;
+    }
+
+    //  times past the range of time_to_cross_type would turn negative, and so would distances past it.
+    //  Dijkstra reaches no further than the optimum and one more crossing, and the optimum takes at
+    //  most 2 n - 3 crossings, so with n people each time is held to a (2 n - 2)th of that range.
+    auto const max_time_word = static_cast<query_word_type>(
+      std::numeric_limits<time_to_cross_type>::max() / static_cast<time_to_cross_type>(std::max<std::size_t>(1, 2 * people_count - 2))
+    );
+    auto const times_words = request.subspan(2, people_count);
+    if (std::ranges::any_of(times_words, [&](query_word_type const word) { return word > max_time_word; })) {
+      return query_status_type::malformed;
+    }
+
+    auto const &graph = *graphs_by_people_count.at(people_count);
+    scratch.times_to_cross.assign(request.begin() + 2, request.begin() + 2 + people_count);
+
+    auto source_state_index = start_state_index;
+    if (kind == query_kind_type::mid_state) {
+      auto const state_repr = request.back();
+      auto const leading_one = graph.states.at(start_state_index).state_repr;
+
+      if (std::bit_floor(state_repr) != leading_one) {
+        return query_status_type::unknown_state;
+      }
+      source_state_index = graph.state_index_by_repr.at(state_repr - leading_one);
+      if (source_state_index == no_state_index) {
+        return query_status_type::unknown_state;
+      }
+    }
+
+    auto const &states = graph.states;
+    auto const &times_to_cross = scratch.times_to_cross;
+
+    run_dijkstra(
+      states,
+      source_state_index,
+      end_state_index,
+      [&](std::size_t const curr_state_index, bridge_state_type::crossing_type const &crossing) {
+        auto const crossers = (
+          states[curr_state_index].state_repr ^ states[crossing.state_index_after_crossing].state_repr
+        ) >> 1;
+        return std::max(
+          times_to_cross[std::countr_zero(crossers)],
+          times_to_cross[std::bit_width(crossers) - 1]
+        );
+      },
+      scratch.distances,
+      scratch.predecessors
+    );
+
+    auto const total_time = scratch.distances.at(end_state_index);
+    response.push_back(static_cast<query_word_type>(query_status_type::ok));
+
+    if (kind == query_kind_type::feasibility) {
+      response.push_back(static_cast<query_word_type>(total_time) <= request.back() ? 1 : 0);
+      response.push_back(static_cast<query_word_type>(total_time));
+      return query_status_type::ok;
+    }
+
+    response.push_back(static_cast<query_word_type>(total_time));
+    auto const state_count_position = response.size();
+    response.push_back(0);
+
+    for (auto state_index = end_state_index;; state_index = scratch.predecessors.at(state_index)) {
+      response.push_back(states.at(state_index).state_repr);
+      if (state_index == source_state_index) {
+        break;
+      }
+    }
+    std::reverse(response.begin() + static_cast<std::ptrdiff_t>(state_count_position) + 1, response.end());
+    response.at(state_count_position) = static_cast<query_word_type>(response.size() - state_count_position - 1);
+
+    return query_status_type::ok;
+  }
+
+  std::vector<std::optional<structural_graph_type>> graphs_by_people_count;
+};
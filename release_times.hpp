@@ -0,0 +1,268 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <format>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <queue>
+#include <stdexcept>
+#include <vector>
+
+#include "bridge_state.hpp"
+#include "memory_tracking.hpp"
+#include "solver_observer.hpp"
+#include "tracing.hpp"
+
+//  a crossing that waited for all of its crossers to arrive before departing
+struct release_crossing_type {
+  bridge_state_type::int_value_type state_repr_after_crossing;
+  time_to_cross_type departure_time;
+  time_to_cross_type arrival_time;
+};
+
+struct release_schedule_type {
+  time_to_cross_type total_time;
+  std::vector<release_crossing_type> crossings;
+};
+
+//  earliest-arrival A* search over (state_repr, time) labels where person i may only depart after
+//  release_times[i]. the torch holder may wait, so every crossing is FIFO: arriving at a state
+//  earlier never hurts, and a label is dominated by any other label of the same state_repr with
+//  an equal or earlier time. only the earliest label per state_repr is kept.
+//
+//  a return by two people is also dominated: the faster of the two returning alone reaches a state
+//  with a superset of people across no later, and such a state can replay any schedule of the
+//  other one at no extra cost. only single returns are generated.
+//
+//  observer is called as in solver_observer.hpp, with label times as distances.
+template <typename observer_type = null_solver_observer_type>
+release_schedule_type solve_with_release_times(
+  std::vector<time_to_cross_type> const &times_to_cross,
+  std::vector<time_to_cross_type> const &release_times,
+  observer_type &&observer = {}
+) {
+  if (release_times.size() != times_to_cross.size()) {
+    throw std::invalid_argument(std::format(
+      "release_times size is out of range. is {}. should be {}.",
+      release_times.size(), times_to_cross.size()
+    ));
+  }
+  ROPE_BRIDGE_TRACE_SPAN_ARG("solve_with_release_times", times_to_cross.size());
+
+  using int_value_type = bridge_state_type::int_value_type;
+
+  auto const people_count = times_to_cross.size();
+  auto const start_state = bridge_state_type::start(people_count);
+  auto const end_state = bridge_state_type::end(people_count);
+
+  //  every state_repr of this people_count lies in [start, 2 * start), so labels are indexed by
+  //  state_repr with the leading one removed
+  auto const label_offset = start_state.state_repr;
+  auto constexpr unreached = std::numeric_limits<time_to_cross_type>::max();
+
+  //  kept together so an improving relaxation touches a single cache line
+  struct best_label_type {
+    time_to_cross_type earliest_time;
+    int_value_type predecessor;
+  };
+  tracked_vector_type<best_label_type, memory_category_type::solver_scratch> best_labels(label_offset, {.earliest_time = unreached, .predecessor = 0});
+
+  std::vector<std::size_t> people_by_time_descending(people_count);
+  std::iota(people_by_time_descending.begin(), people_by_time_descending.end(), std::size_t {0});
+  std::ranges::stable_sort(
+    people_by_time_descending,
+    std::ranges::greater {},
+    [&](std::size_t const person_index) { return times_to_cross.at(person_index); }
+  );
+  auto const fastest_time = times_to_cross.at(people_by_time_descending.back());
+
+  //  labels are expanded in order of a lower bound on the total time, the larger of
+  //  - everyone still before the bridge departing after both the current time and their release time
+  //  - the forward crossings still needed, at most two of the people before the bridge per crossing
+  //    so at least every other of their times from the slowest down, plus the returns those
+  //    crossings force, each at least as slow as the fastest person
+  //  the bound is admissible, and a label improved after its state_repr was expanded is expanded
+  //  again, so the first label popped for the end state is the earliest
+  auto const lower_bound = [&](int_value_type const state_repr, time_to_cross_type const time) {
+    auto const uncrossed = ~state_repr >> 1 & (label_offset >> 1) - 1;
+
+    auto release_bound = time;
+    time_to_cross_type crossings_bound = 0;
+    std::size_t uncrossed_count = 0;
+
+    for (auto const person_index : people_by_time_descending) {
+      if ((uncrossed >> person_index & 1) == 0) {
+        continue;
+      }
+
+      auto const person_time = times_to_cross.at(person_index);
+      release_bound = std::max(
+        release_bound,
+        std::max(time, release_times.at(person_index)) + person_time
+      );
+      if (uncrossed_count++ % 2 == 0) {
+        crossings_bound += person_time;
+      }
+    }
+
+    if (uncrossed_count == 0) {
+      return time;
+    }
+
+    auto const return_count = (state_repr & 1) == 1
+      ? uncrossed_count
+      : uncrossed_count - std::min(uncrossed_count, std::size_t {2});
+    crossings_bound += static_cast<time_to_cross_type>(return_count) * fastest_time;
+
+    return std::max(release_bound, time + crossings_bound);
+  };
+
+  struct label_type {
+    time_to_cross_type bound;
+    time_to_cross_type time;
+    int_value_type state_repr;
+
+    bool operator>(label_type const &other) const {
+      return bound > other.bound || (bound == other.bound && time < other.time);
+    }
+  };
+  std::priority_queue<
+    label_type, tracked_vector_type<label_type, memory_category_type::solver_scratch>, std::greater<>
+  > frontier;
+
+  auto const try_improve = [&](
+    int_value_type const prior_state_repr,
+    bridge_state_type const &crossed_state,
+    time_to_cross_type const arrival_time
+  ) {
+    auto &best_label = best_labels.at(crossed_state.state_repr - label_offset);
+    observer.on_relax(prior_state_repr, crossed_state.state_repr, arrival_time);
+    if (arrival_time >= best_label.earliest_time) {
+      return;
+    }
+    observer.on_improve(prior_state_repr, crossed_state.state_repr, arrival_time);
+    best_label = {.earliest_time = arrival_time, .predecessor = prior_state_repr};
+    frontier.push({
+      .bound = lower_bound(crossed_state.state_repr, arrival_time),
+      .time = arrival_time,
+      .state_repr = crossed_state.state_repr
+    });
+  };
+
+  best_labels.at(0).earliest_time = 0;
+  frontier.push({
+    .bound = lower_bound(start_state.state_repr, 0),
+    .time = 0,
+    .state_repr = start_state.state_repr
+  });
+
+  while (!frontier.empty()) {
+    auto const label = frontier.top();
+    frontier.pop();
+
+    if (label.time > best_labels.at(label.state_repr - label_offset).earliest_time) {
+      continue;
+    }
+    if (label.state_repr == end_state.state_repr) {
+      observer.on_goal(label.state_repr, label.time);
+      break;
+    }
+    observer.on_pop(label.state_repr, label.time, frontier.size());
+
+    bridge_state_type const curr_state {.state_repr = label.state_repr};
+    auto const possible_crosser_indices = curr_state.get_possible_crosser_indices();
+
+    if (curr_state.get_torch_crossed()) {
+      std::size_t crosser_index = 0;
+
+      for (
+        auto iterated_possible_crosser_indices = possible_crosser_indices;
+        iterated_possible_crosser_indices != 0;
+        ++crosser_index, iterated_possible_crosser_indices >>= 1
+      ) {
+        if ((iterated_possible_crosser_indices & 1) == 0) {
+          continue;
+        }
+
+        try_improve(
+          label.state_repr,
+          bridge_state_type::after_single_crossing<hot_path_bridge_state_checking>(curr_state, crosser_index),
+          label.time + times_to_cross.at(crosser_index)
+        );
+      }
+
+      continue;
+    }
+
+    std::size_t first_crosser_index = 0;
+
+    for (
+      auto first_crosser_iterated_possible_crosser_indices = possible_crosser_indices;
+      first_crosser_iterated_possible_crosser_indices != 0;
+      ++first_crosser_index, first_crosser_iterated_possible_crosser_indices >>= 1
+    ) {
+      if ((first_crosser_iterated_possible_crosser_indices & 1) == 0) {
+        continue;
+      }
+
+      auto const first_departure_time = std::max(label.time, release_times.at(first_crosser_index));
+
+      try_improve(
+        label.state_repr,
+        bridge_state_type::after_single_crossing<hot_path_bridge_state_checking>(curr_state, first_crosser_index),
+        first_departure_time + times_to_cross.at(first_crosser_index)
+      );
+
+      auto second_crosser_index = first_crosser_index + 1;
+
+      for (
+        auto second_crosser_iterated_possible_crosser_indices
+          = first_crosser_iterated_possible_crosser_indices >> 1;
+        second_crosser_iterated_possible_crosser_indices != 0;
+        ++second_crosser_index, second_crosser_iterated_possible_crosser_indices >>= 1
+      ) {
+        if ((second_crosser_iterated_possible_crosser_indices & 1) == 0) {
+          continue;
+        }
+
+        try_improve(
+          label.state_repr,
+          bridge_state_type::after_double_crossing<hot_path_bridge_state_checking>(curr_state, first_crosser_index, second_crosser_index),
+          std::max(first_departure_time, release_times.at(second_crosser_index))
+            + std::max(times_to_cross.at(first_crosser_index), times_to_cross.at(second_crosser_index))
+        );
+      }
+    }
+  }
+
+  release_schedule_type result {
+    .total_time = best_labels.at(end_state.state_repr - label_offset).earliest_time,
+    .crossings = {}
+  };
+
+  for (
+    auto state_repr = end_state.state_repr;
+    state_repr != start_state.state_repr;
+    state_repr = best_labels.at(state_repr - label_offset).predecessor
+  ) {
+    auto const &best_label = best_labels.at(state_repr - label_offset);
+    auto const crossers = (state_repr ^ best_label.predecessor) >> 1;
+    time_to_cross_type crossing_time = 0;
+    for (std::size_t crosser_index = 0; crosser_index < people_count; ++crosser_index) {
+      if ((crossers >> crosser_index & 1) == 1) {
+        crossing_time = std::max(crossing_time, times_to_cross.at(crosser_index));
+      }
+    }
+
+    result.crossings.push_back({
+      .state_repr_after_crossing = state_repr,
+      .departure_time = best_label.earliest_time - crossing_time,
+      .arrival_time = best_label.earliest_time
+    });
+  }
+  std::ranges::reverse(result.crossings);
+
+  return result;
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "bridge_state.hpp"
+#include "mapped_file.hpp"
+#include "tracing.hpp"
+
+enum class schedule_violation_type {
+  none,
+  no_crossers,
+  too_many_crossers,
+  //  a crosser index at or past the people count
+  unknown_crosser,
+  //  a crosser on the other side of the bridge than the torch
+  crosser_away_from_torch,
+  //  every step is legal but someone is still before the bridge
+  unfinished
+};
+
+struct schedule_validation_type {
+  schedule_violation_type violation;
+  //  the first illegal step, or the step count when there is none
+  std::size_t step_index;
+  //  of the legal steps
+  std::int64_t total_time;
+};
+
+//  checks schedules given as one crosser mask per step, bit i standing for person i, with the same
+//  transitions as after_single_crossing and after_double_crossing. the people count is validated once by
+//  from_times, after which a step is a few bit operations and never throws.
+struct schedule_validator_type {
+  using crosser_mask_type = bridge_state_type::int_value_type;
+
+  static schedule_validator_type from_times(std::vector<time_to_cross_type> const &times_to_cross) {
+    //  validates the people count
+    static_cast<void>(bridge_state_type::start(times_to_cross.size()));
+    return {.times_to_cross = times_to_cross};
+  }
+
+  [[nodiscard]] schedule_validation_type validate(std::span<crosser_mask_type const> const crosser_masks) const noexcept {
+    auto const people_count = times_to_cross.size();
+    auto const people_mask = (crosser_mask_type {1} << people_count) - 1;
+    auto const times = times_to_cross.data();
+
+    //  the people bits of state_repr with the torch bit kept apart
+    crosser_mask_type crossed_people = 0;
+    bool torch_crossed = false;
+    schedule_validation_type result {.violation = schedule_violation_type::none, .step_index = 0, .total_time = 0};
+
+    for (; result.step_index < crosser_masks.size(); ++result.step_index) {
+      auto const crossers = crosser_masks[result.step_index];
+      auto const crosser_count = std::popcount(crossers);
+      auto const torch_side_people = torch_crossed ? crossed_people : crossed_people ^ people_mask;
+
+      if (crosser_count == 0) {
+        result.violation = schedule_violation_type::no_crossers;
+        return result;
+      }
+      if (crosser_count > 2) {
+        result.violation = schedule_violation_type::too_many_crossers;
+        return result;
+      }
+      if ((crossers & ~people_mask) != 0) {
+        result.violation = schedule_violation_type::unknown_crosser;
+        return result;
+      }
+      if ((crossers & ~torch_side_people) != 0) {
+        result.violation = schedule_violation_type::crosser_away_from_torch;
+        return result;
+      }
+
+      auto const first_crosser_index = std::countr_zero(crossers);
+      auto const last_crosser_index = std::bit_width(crossers) - 1;
+      result.total_time += std::max(times[first_crosser_index], times[last_crosser_index]);
+
+      crossed_people ^= crossers;
+      torch_crossed = !torch_crossed;
+    }
+
+    if (crossed_people != people_mask) {
+      result.violation = schedule_violation_type::unfinished;
+    }
+    return result;
+  }
+
+  //  validates every schedule of a file of native-endian crosser_mask_type words, each schedule being
+  //  its step count followed by its masks, calling on_validated(schedule_index, validation) in order.
+  //  the file is mapped rather than read, and only a truncated file throws.
+  template <typename on_validated_type>
+  std::size_t validate_file(std::string const &path, on_validated_type &&on_validated) const {
+    ROPE_BRIDGE_TRACE_SPAN("validate_schedule_file");
+    auto const file = mapped_file_type::open_read_only(path);
+    auto const bytes = file.get_bytes();
+
+    if (bytes.size() % sizeof(crosser_mask_type) != 0) {
+      throw std::invalid_argument(std::format(
+        "file size of {} is out of range. is {}. should be a multiple of {}.",
+        path, bytes.size(), sizeof(crosser_mask_type)
+      ));
+    }
+
+    std::span const words {
+      reinterpret_cast<crosser_mask_type const *>(bytes.data()), bytes.size() / sizeof(crosser_mask_type)
+    };
+
+    std::size_t schedule_index = 0;
+    for (std::size_t word_index = 0; word_index < words.size(); ++schedule_index) {
+      auto const step_count = std::size_t {words[word_index]};
+      if (step_count > words.size() - word_index - 1) {
+        throw std::invalid_argument(std::format(
+          "step count of schedule {} in {} is out of range. is {}. should be at most {}.",
+          schedule_index, path, step_count, words.size() - word_index - 1
+        ));
+      }
+
+      on_validated(schedule_index, validate(words.subspan(word_index + 1, step_count)));
+      word_index += 1 + step_count;
+    }
+
+    return schedule_index;
+  }
+
+  std::vector<time_to_cross_type> times_to_cross;
+};
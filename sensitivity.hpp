@@ -0,0 +1,264 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <iterator>
+#include <utility>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "bridge_state.hpp"
+#include "parametric.hpp"
+#include "shortest_path.hpp"
+#include "state_graph.hpp"
+
+struct person_sensitivity_type {
+  //  derivatives of the optimum with respect to this person's time, from below and from above
+  std::size_t left_slope;
+  std::size_t right_slope;
+  //  the optimal schedule stays optimal while this person's time stays within [min_time, max_time].
+  //  max_time is infinite when no larger time makes another schedule faster.
+  double min_time;
+  double max_time;
+};
+
+struct sensitivity_report_type {
+  time_to_cross_type total_time;
+  std::vector<std::size_t> state_indices;
+  std::vector<person_sensitivity_type> people;
+};
+
+//  the optimal schedule and, for every person, the derivatives of the optimum and the range of their
+//  time over which that schedule stays optimal. times must be positive.
+//
+//  the derivatives come from one pair of Dijkstra runs. a crossing is tight when it lies on some
+//  optimal path, and the optimum is the minimum over those paths, so its derivative from above is the
+//  fewest crossings on a tight path that this person leads, and from below the most crossings they
+//  lead strictly. both are found by one pass over the tight crossings in distance order.
+//
+//  the ranges come from the same tight crossings where the schedule's slope on a side of the person's
+//  time is not the optimum's derivative there, since another schedule is then faster at once on that
+//  side. elsewhere they follow the optimum's curve in the person's time, extended outwards from it by
+//  append_optimum_curve_interval only as far as the schedule stays on it, so each interval between
+//  other people's times is solved once and only its breakpoints beyond that.
+inline sensitivity_report_type analyze_sensitivity(
+  states_list_type const &states,
+  std::vector<time_to_cross_type> const &times_to_cross
+) {
+  auto const people_count = states.at(start_state_index).get_people_count();
+  if (times_to_cross.size() != people_count) {
+    throw std::invalid_argument(std::format(
+      "times_to_cross size is out of range. is {}. should be {}.",
+      times_to_cross.size(), people_count
+    ));
+  }
+  for (std::size_t person_index = 0; person_index < people_count; ++person_index) {
+    if (times_to_cross.at(person_index) <= 0) {
+      throw std::invalid_argument(std::format(
+        "time to cross of person {} is out of range. is {}. should be positive.",
+        person_index, times_to_cross.at(person_index)
+      ));
+    }
+  }
+
+  auto const optimum = solve_shortest_path(states);
+  sensitivity_report_type result {
+    .total_time = optimum.total_time,
+    .state_indices = optimum.state_indices,
+    .people = {}
+  };
+
+  auto const get_crossers = [&](std::size_t const from_state_index, std::size_t const to_state_index) {
+    return (states.at(from_state_index).state_repr ^ states.at(to_state_index).state_repr) >> 1;
+  };
+
+  struct tight_crossing_type {
+    std::size_t from_state_index;
+    std::size_t to_state_index;
+    bridge_state_type::int_value_type crossers;
+  };
+  std::vector<tight_crossing_type> tight_crossings;
+
+  {
+    auto const start_distances = get_shortest_distances(states, start_state_index, get_static_crossing_cost);
+    auto const end_distances = get_shortest_distances(states, end_state_index, get_static_crossing_cost);
+
+    for (std::size_t state_index = 0; state_index < states.size(); ++state_index) {
+      if (start_distances.at(state_index) + end_distances.at(state_index) != optimum.total_time) {
+        continue;
+      }
+      for (auto const &crossing : states.at(state_index).possible_crossings) {
+        if (
+          start_distances.at(state_index) + crossing.time_to_cross + end_distances.at(crossing.state_index_after_crossing)
+            == optimum.total_time
+        ) {
+          tight_crossings.push_back({
+            .from_state_index = state_index,
+            .to_state_index = crossing.state_index_after_crossing,
+            .crossers = get_crossers(state_index, crossing.state_index_after_crossing)
+          });
+        }
+      }
+    }
+
+    //  positive times make distance order a topological order of the tight crossings
+    std::ranges::sort(tight_crossings, {}, [&](tight_crossing_type const &tight_crossing) {
+      return start_distances.at(tight_crossing.from_state_index);
+    });
+  }
+
+  auto constexpr unreached = std::numeric_limits<std::size_t>::max();
+  std::vector<std::size_t> fewest_led(states.size());
+  std::vector<std::size_t> most_strictly_led(states.size());
+
+  for (std::size_t person_index = 0; person_index < people_count; ++person_index) {
+    auto const person_time = times_to_cross.at(person_index);
+    person_sensitivity_type sensitivity {};
+
+    //  derivatives over the tight crossings
+    std::ranges::fill(fewest_led, unreached);
+    std::ranges::fill(most_strictly_led, 0);
+    fewest_led.at(start_state_index) = 0;
+
+    for (auto const &tight_crossing : tight_crossings) {
+      if (fewest_led.at(tight_crossing.from_state_index) == unreached) {
+        continue;
+      }
+
+      auto const led = (tight_crossing.crossers >> person_index & 1) == 1;
+      auto const other_time = get_other_crossers_time(times_to_cross, tight_crossing.crossers, person_index);
+
+      fewest_led.at(tight_crossing.to_state_index) = std::min(
+        fewest_led.at(tight_crossing.to_state_index),
+        fewest_led.at(tight_crossing.from_state_index) + (led && person_time >= other_time ? 1 : 0)
+      );
+      most_strictly_led.at(tight_crossing.to_state_index) = std::max(
+        most_strictly_led.at(tight_crossing.to_state_index),
+        most_strictly_led.at(tight_crossing.from_state_index) + (led && person_time > other_time ? 1 : 0)
+      );
+    }
+
+    sensitivity.right_slope = fewest_led.at(end_state_index);
+    sensitivity.left_slope = most_strictly_led.at(end_state_index);
+
+    //  the schedule is a tight path, so where its slope on one side of person_time is not the
+    //  derivative of the optimum there, another schedule is faster just past person_time on that side
+    auto const leaves_upwards = static_cast<std::size_t>(get_parametric_path_slope(
+      states, times_to_cross, optimum.state_indices, person_index, person_time
+    )) != sensitivity.right_slope;
+    auto const leaves_downwards = static_cast<std::size_t>(get_parametric_path_slope(
+      states, times_to_cross, optimum.state_indices, person_index, person_time - 1
+    )) != sensitivity.left_slope;
+    sensitivity.min_time = person_time;
+    sensitivity.max_time = person_time;
+    if (leaves_upwards && leaves_downwards) {
+      result.people.push_back(sensitivity);
+      continue;
+    }
+
+    //  between the other people's times both the optimum and the schedule's length are linear, so the
+    //  optimum's curve is extended an interval at a time outwards from person_time and the schedule
+    //  stays optimal over each piece of it sharing its slope. past the slowest other time, a faster
+    //  path has to beat the schedule by less than its own length, which bounds the last interval.
+    std::vector<std::int64_t> other_times;
+    for (std::size_t other_index = 0; other_index < people_count; ++other_index) {
+      if (other_index != person_index) {
+        other_times.push_back(times_to_cross.at(other_index));
+      }
+    }
+    std::ranges::sort(other_times);
+    other_times.erase(std::ranges::unique(other_times).begin(), other_times.end());
+
+    //  the breakpoints of the optimum within [interval_start, interval_end), and the schedule's slope
+    //  over them
+    std::vector<optimum_curve_breakpoint_type> curve;
+    auto const extend_curve = [&](
+      std::int64_t const interval_start,
+      std::int64_t const interval_end,
+      std::vector<std::size_t> const &start_state_indices,
+      std::vector<std::size_t> const &end_state_indices
+    ) {
+      curve.clear();
+      append_optimum_curve_interval(
+        states, times_to_cross, person_index, interval_start, start_state_indices, end_state_indices, curve
+      );
+      while (!curve.empty() && curve.back().time_to_cross >= static_cast<double>(interval_end)) {
+        curve.pop_back();
+      }
+      return get_parametric_path_slope(states, times_to_cross, optimum.state_indices, person_index, interval_start);
+    };
+
+    //  upwards, infinite when the schedule is optimal over the last interval
+    if (!leaves_upwards) {
+      std::vector<std::int64_t> interval_ends(std::ranges::upper_bound(other_times, person_time), other_times.end());
+      auto const last_interval_start = interval_ends.empty() ? std::int64_t {person_time} : interval_ends.back();
+      auto const state_factor = static_cast<std::int64_t>(states.size()) + 1;
+      if (last_interval_start > (std::numeric_limits<std::int64_t>::max() - 1) / state_factor) {
+        throw std::invalid_argument(std::format(
+          "times_to_cross are out of range. the largest is {}. should be at most {} for {} states.",
+          last_interval_start, (std::numeric_limits<std::int64_t>::max() - 1) / state_factor, states.size()
+        ));
+      }
+      interval_ends.push_back(last_interval_start * state_factor + 1);
+
+      sensitivity.max_time = std::numeric_limits<double>::infinity();
+      std::int64_t interval_start = person_time;
+      auto start_state_indices = optimum.state_indices;
+
+      for (auto const interval_end : interval_ends) {
+        auto end_state_indices = solve_parametric_shortest_path(
+          states, times_to_cross, person_index, interval_end, 1
+        ).state_indices;
+        auto const slope = extend_curve(interval_start, interval_end, start_state_indices, end_state_indices);
+
+        auto const departure = std::ranges::find_if(curve, [&](optimum_curve_breakpoint_type const &breakpoint) {
+          return breakpoint.slope != slope;
+        });
+        if (departure != curve.end()) {
+          sensitivity.max_time = departure->time_to_cross;
+          break;
+        }
+        interval_start = interval_end;
+        start_state_indices = std::move(end_state_indices);
+      }
+    }
+
+    //  downwards, to zero at most
+    if (!leaves_downwards) {
+      std::vector<std::int64_t> interval_starts(other_times.begin(), std::ranges::lower_bound(other_times, person_time));
+      std::ranges::reverse(interval_starts);
+      interval_starts.push_back(0);
+
+      sensitivity.min_time = 0;
+      std::int64_t interval_end = person_time;
+      auto end_state_indices = optimum.state_indices;
+
+      for (auto const interval_start : interval_starts) {
+        auto start_state_indices = solve_parametric_shortest_path(
+          states, times_to_cross, person_index, interval_start, 1
+        ).state_indices;
+        auto const slope = extend_curve(interval_start, interval_end, start_state_indices, end_state_indices);
+
+        //  the last piece not sharing the schedule's slope ends where the schedule starts being optimal
+        auto const departure = std::find_if(curve.rbegin(), curve.rend(), [&](optimum_curve_breakpoint_type const &breakpoint) {
+          return breakpoint.slope != slope;
+        });
+        if (departure != curve.rend()) {
+          sensitivity.min_time = departure == curve.rbegin()
+            ? static_cast<double>(interval_end)
+            : std::prev(departure)->time_to_cross;
+          break;
+        }
+        interval_end = interval_start;
+        end_state_indices = std::move(start_state_indices);
+      }
+    }
+
+    result.people.push_back(sensitivity);
+  }
+
+  return result;
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "bridge_state.hpp"
+#include "memory_tracking.hpp"
+#include "solver_observer.hpp"
+#include "state_graph.hpp"
+#include "tracing.hpp"
+
+template <typename crossing_cost_function_type>
+using crossing_cost_type = std::remove_cvref_t<std::invoke_result_t<
+  crossing_cost_function_type const &, std::size_t, bridge_state_type::crossing_type const &
+>>;
+
+//  Dijkstra over a graph from build_state_graph from source_state_index, weighing each crossing by
+//  crossing_cost(curr_state_index, crossing). stops once stop_state_index is settled, so with a
+//  stop state only the distances of settled states are final. unreached states keep the max distance.
+//  observer is called as in solver_observer.hpp. distances and predecessors may be vectors of any
+//  allocator.
+template <
+  typename crossing_cost_function_type,
+  typename distances_type,
+  typename predecessors_type,
+  typename observer_type = null_solver_observer_type
+>
+void run_dijkstra(
+  states_list_type const &states,
+  std::size_t const source_state_index,
+  std::size_t const stop_state_index,
+  crossing_cost_function_type const &crossing_cost,
+  distances_type &distances,
+  predecessors_type &predecessors,
+  observer_type &&observer = {}
+) {
+  ROPE_BRIDGE_TRACE_SPAN_ARG("run_dijkstra", states.size());
+  using distance_type = typename distances_type::value_type;
+  auto constexpr unreached = std::numeric_limits<distance_type>::max();
+  distances.assign(states.size(), unreached);
+  predecessors.assign(states.size(), source_state_index);
+
+  struct label_type {
+    distance_type distance;
+    std::size_t state_index;
+
+    bool operator>(label_type const &other) const {
+      return distance > other.distance;
+    }
+  };
+  std::priority_queue<
+    label_type, tracked_vector_type<label_type, memory_category_type::solver_scratch>, std::greater<>
+  > frontier;
+
+  distances.at(source_state_index) = 0;
+  frontier.push({.distance = 0, .state_index = source_state_index});
+
+  while (!frontier.empty()) {
+    auto const label = frontier.top();
+    frontier.pop();
+
+    if (label.distance > distances.at(label.state_index)) {
+      continue;
+    }
+    auto const &curr_state = states.at(label.state_index);
+    if (label.state_index == stop_state_index) {
+      observer.on_goal(curr_state.state_repr, label.distance);
+      break;
+    }
+    observer.on_pop(curr_state.state_repr, label.distance, frontier.size());
+
+    for (auto const &crossing : curr_state.possible_crossings) {
+      auto const distance = label.distance + crossing_cost(label.state_index, crossing);
+      //  unchecked, so the load is dropped along with the calls of a null observer
+      auto const crossed_state_repr = states[crossing.state_index_after_crossing].state_repr;
+      observer.on_relax(curr_state.state_repr, crossed_state_repr, distance);
+      if (distance >= distances.at(crossing.state_index_after_crossing)) {
+        continue;
+      }
+      observer.on_improve(curr_state.state_repr, crossed_state_repr, distance);
+      distances.at(crossing.state_index_after_crossing) = distance;
+      predecessors.at(crossing.state_index_after_crossing) = label.state_index;
+      frontier.push({.distance = distance, .state_index = crossing.state_index_after_crossing});
+    }
+  }
+}
+
+//  distances of every state from source_state_index
+template <typename crossing_cost_function_type>
+auto get_shortest_distances(
+  states_list_type const &states,
+  std::size_t const source_state_index,
+  crossing_cost_function_type const &crossing_cost
+) {
+  std::vector<crossing_cost_type<crossing_cost_function_type>> distances;
+  std::vector<std::size_t> predecessors;
+  run_dijkstra(states, source_state_index, states.size(), crossing_cost, distances, predecessors);
+  return distances;
+}
+
+template <typename distance_type>
+struct shortest_path_type {
+  distance_type total_time;
+  //  from start_state_index to end_state_index
+  std::vector<std::size_t> state_indices;
+};
+
+//  the shortest path from the start state to the end state
+template <typename crossing_cost_function_type, typename observer_type = null_solver_observer_type>
+auto solve_shortest_path(
+  states_list_type const &states,
+  crossing_cost_function_type const &crossing_cost,
+  observer_type &&observer = {}
+) {
+  using distance_type = crossing_cost_type<crossing_cost_function_type>;
+
+  tracked_vector_type<distance_type, memory_category_type::solver_scratch> distances;
+  tracked_vector_type<std::size_t, memory_category_type::solver_scratch> predecessors;
+  run_dijkstra(
+    states, start_state_index, end_state_index, crossing_cost, distances, predecessors,
+    std::forward<observer_type>(observer)
+  );
+
+  shortest_path_type<distance_type> result {
+    .total_time = distances.at(end_state_index),
+    .state_indices = {end_state_index}
+  };
+  for (auto state_index = end_state_index; state_index != start_state_index;) {
+    state_index = predecessors.at(state_index);
+    result.state_indices.push_back(state_index);
+  }
+  std::ranges::reverse(result.state_indices);
+
+  return result;
+}
+
+inline time_to_cross_type get_static_crossing_cost(std::size_t, bridge_state_type::crossing_type const &crossing) {
+  return crossing.time_to_cross;
+}
+
+inline shortest_path_type<time_to_cross_type> solve_shortest_path(states_list_type const &states) {
+  return solve_shortest_path(states, get_static_crossing_cost);
+}
@@ -0,0 +1,262 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <list>
+#include <numeric>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "bridge_state.hpp"
+#include "fixed_people_count.hpp"
+#include "mapped_file.hpp"
+
+//  an instance with its times sorted ascending, which does not change the optimum. canonical person i
+//  is original person original_person_indices[i].
+struct canonical_instance_type {
+  std::vector<time_to_cross_type> times_to_cross;
+  std::vector<std::size_t> original_person_indices;
+
+  static canonical_instance_type from_times(std::vector<time_to_cross_type> const &times_to_cross) {
+    canonical_instance_type result;
+    result.original_person_indices.resize(times_to_cross.size());
+    std::iota(result.original_person_indices.begin(), result.original_person_indices.end(), std::size_t {0});
+    std::ranges::stable_sort(result.original_person_indices, {}, [&](std::size_t const person_index) {
+      return times_to_cross.at(person_index);
+    });
+
+    result.times_to_cross.reserve(times_to_cross.size());
+    for (auto const person_index : result.original_person_indices) {
+      result.times_to_cross.push_back(times_to_cross.at(person_index));
+    }
+
+    return result;
+  }
+
+  //  a schedule of the canonical instance as a schedule of the original one
+  [[nodiscard]] fixed_schedule_type to_original(fixed_schedule_type const &canonical_schedule) const {
+    auto const people_count = original_person_indices.size();
+    auto const leading_one_and_torch = (bridge_state_type::int_value_type {2} << people_count) | 1;
+
+    fixed_schedule_type result {.total_time = canonical_schedule.total_time, .state_reprs = {}};
+    result.state_reprs.reserve(canonical_schedule.state_reprs.size());
+
+    for (auto const canonical_state_repr : canonical_schedule.state_reprs) {
+      auto state_repr = canonical_state_repr & leading_one_and_torch;
+      std::size_t canonical_person_index = 0;
+
+      for (
+        auto iterated_people = canonical_state_repr >> 1 & ((bridge_state_type::int_value_type {1} << people_count) - 1);
+        iterated_people != 0;
+        ++canonical_person_index, iterated_people >>= 1
+      ) {
+        if ((iterated_people & 1) == 0) {
+          continue;
+        }
+        state_repr |= bridge_state_type::int_value_type {2} << original_person_indices.at(canonical_person_index);
+      }
+
+      result.state_reprs.push_back(state_repr);
+    }
+
+    return result;
+  }
+};
+
+inline std::uint64_t get_canonical_times_hash(std::vector<time_to_cross_type> const &canonical_times_to_cross) {
+  //  FNV-1a over the times, with a splitmix64 finalizer for the low bits used by probing
+  std::uint64_t result = 14695981039346656037ull ^ canonical_times_to_cross.size();
+  for (auto const time_to_cross : canonical_times_to_cross) {
+    result = (result ^ static_cast<std::uint32_t>(time_to_cross)) * 1099511628211ull;
+  }
+  result = (result ^ result >> 30) * 0xbf58476d1ce4e5b9ull;
+  result = (result ^ result >> 27) * 0x94d049bb133111ebull;
+  return result ^ result >> 31;
+}
+
+//  optimal schedules of solved instances, keyed by their canonical times, kept in a file mapped as an
+//  open addressing hash table with linear probing and, in front of it, an in-process LRU cache.
+//
+//  the file is a header followed by slot_count fixed-size slots and is used in place; a slot is
+//  written before its hash, which marks it as used. the table does not grow, and once it is full new
+//  solutions only go to the LRU cache. one process at a time may use a file.
+struct solution_store_type {
+  static solution_store_type open(
+    std::string const &path,
+    std::size_t const slot_count,
+    std::size_t const cache_capacity
+  ) {
+    if (slot_count == 0 || cache_capacity == 0) {
+      throw std::invalid_argument(std::format(
+        "slot_count and cache_capacity are out of range. are {} and {}. should be positive.",
+        slot_count, cache_capacity
+      ));
+    }
+
+    solution_store_type result {
+      mapped_file_type::open_or_create(path, sizeof(header_type) + slot_count * sizeof(slot_type)),
+      cache_capacity
+    };
+    auto const bytes = result.file.get_writable_bytes();
+    auto const throw_not_a_store = [&] {
+      throw std::invalid_argument(std::format("file {} is out of range. should be a solution store.", path));
+    };
+
+    //  an existing file keeps its size, so it is checked before anything in it is read or written
+    if (bytes.size() < sizeof(header_type)) {
+      throw_not_a_store();
+    }
+    auto &header = *reinterpret_cast<header_type *>(bytes.data());
+
+    if (header.magic == 0) {
+      if (bytes.size() != sizeof(header_type) + slot_count * sizeof(slot_type)) {
+        throw_not_a_store();
+      }
+      header = {.magic = store_magic, .slot_size = sizeof(slot_type), .slot_count = slot_count};
+    }
+    if (
+      header.magic != store_magic
+        || header.slot_size != sizeof(slot_type)
+        || bytes.size() != sizeof(header_type) + header.slot_count * sizeof(slot_type)
+    ) {
+      throw_not_a_store();
+    }
+
+    result.slots = {reinterpret_cast<slot_type *>(bytes.data() + sizeof(header_type)), header.slot_count};
+    return result;
+  }
+
+  //  the optimal schedule of times_to_cross from the cache, the file, or a fresh solve_fixed, in that
+  //  order. a solved instance is added to both.
+  fixed_schedule_type solve(std::vector<time_to_cross_type> const &times_to_cross) {
+    auto const instance = canonical_instance_type::from_times(times_to_cross);
+    auto const hash = get_canonical_times_hash(instance.times_to_cross) | 1;
+
+    if (auto const cached = cache_index.find(instance.times_to_cross); cached != cache_index.end()) {
+      ++cache_hit_count;
+      recently_used.splice(recently_used.begin(), recently_used, cached->second);
+      return instance.to_original(cached->second->second);
+    }
+
+    auto const slot = find_slot(hash, instance.times_to_cross);
+    fixed_schedule_type canonical_schedule;
+
+    if (slot != nullptr && slot->hash == hash) {
+      ++file_hit_count;
+      canonical_schedule = {
+        .total_time = slot->total_time,
+        .state_reprs = {slot->state_reprs.begin(), slot->state_reprs.begin() + slot->state_count}
+      };
+    } else {
+      ++miss_count;
+      canonical_schedule = solve_fixed(instance.times_to_cross);
+      if (slot != nullptr && canonical_schedule.state_reprs.size() <= max_state_count) {
+        write_slot(*slot, hash, instance.times_to_cross, canonical_schedule);
+      }
+    }
+
+    remember(instance.times_to_cross, canonical_schedule);
+    return instance.to_original(canonical_schedule);
+  }
+
+  std::size_t cache_hit_count = 0;
+  std::size_t file_hit_count = 0;
+  std::size_t miss_count = 0;
+
+  private:
+  static auto constexpr store_magic = std::uint64_t {0x31'45'52'4f'54'53'42'52ull};
+  //  an optimal schedule of n >= 2 people has 2 n - 3 crossings
+  static auto constexpr max_state_count = std::size_t {2 * bridge_state_type::max_people};
+
+  struct header_type {
+    std::uint64_t magic;
+    std::uint64_t slot_size;
+    std::uint64_t slot_count;
+  };
+
+  struct slot_type {
+    //  0 while unused, odd otherwise
+    std::uint64_t hash;
+    std::uint32_t people_count;
+    std::uint32_t state_count;
+    time_to_cross_type total_time;
+    std::array<time_to_cross_type, bridge_state_type::max_people> times_to_cross;
+    std::array<bridge_state_type::int_value_type, max_state_count> state_reprs;
+  };
+  static_assert(std::is_trivially_copyable_v<slot_type>);
+
+  struct canonical_times_hash_type {
+    std::size_t operator()(std::vector<time_to_cross_type> const &canonical_times_to_cross) const {
+      return static_cast<std::size_t>(get_canonical_times_hash(canonical_times_to_cross));
+    }
+  };
+
+  using recently_used_type = std::list<std::pair<std::vector<time_to_cross_type>, fixed_schedule_type>>;
+
+  solution_store_type(mapped_file_type &&file, std::size_t const cache_capacity)
+    : file {std::move(file)}, cache_capacity {cache_capacity} {
+  }
+
+  //  the slot holding the instance, else the empty slot it would go to, else nullptr when the table is full
+  [[nodiscard]] slot_type *find_slot(
+    std::uint64_t const hash,
+    std::vector<time_to_cross_type> const &canonical_times_to_cross
+  ) const {
+    for (std::size_t probe_count = 0; probe_count < slots.size(); ++probe_count) {
+      auto &slot = slots[(hash + probe_count) % slots.size()];
+
+      if (slot.hash == 0) {
+        return &slot;
+      }
+      if (
+        slot.hash == hash
+          && slot.people_count == canonical_times_to_cross.size()
+          && std::equal(canonical_times_to_cross.begin(), canonical_times_to_cross.end(), slot.times_to_cross.begin())
+      ) {
+        return &slot;
+      }
+    }
+    return nullptr;
+  }
+
+  static void write_slot(
+    slot_type &slot,
+    std::uint64_t const hash,
+    std::vector<time_to_cross_type> const &canonical_times_to_cross,
+    fixed_schedule_type const &canonical_schedule
+  ) {
+    slot.people_count = static_cast<std::uint32_t>(canonical_times_to_cross.size());
+    slot.state_count = static_cast<std::uint32_t>(canonical_schedule.state_reprs.size());
+    slot.total_time = canonical_schedule.total_time;
+    std::ranges::copy(canonical_times_to_cross, slot.times_to_cross.begin());
+    std::ranges::copy(canonical_schedule.state_reprs, slot.state_reprs.begin());
+    slot.hash = hash;
+  }
+
+  void remember(
+    std::vector<time_to_cross_type> const &canonical_times_to_cross,
+    fixed_schedule_type const &canonical_schedule
+  ) {
+    recently_used.emplace_front(canonical_times_to_cross, canonical_schedule);
+    cache_index.insert_or_assign(canonical_times_to_cross, recently_used.begin());
+
+    if (recently_used.size() > cache_capacity) {
+      cache_index.erase(recently_used.back().first);
+      recently_used.pop_back();
+    }
+  }
+
+  mapped_file_type file;
+  std::span<slot_type> slots;
+  std::size_t cache_capacity;
+  recently_used_type recently_used;
+  std::unordered_map<std::vector<time_to_cross_type>, recently_used_type::iterator, canonical_times_hash_type> cache_index;
+};
@@ -0,0 +1,207 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+//  an HDR-style histogram of latencies in nanoseconds: values below 2^sub_bucket_bits are counted
+//  exactly and larger ones in buckets holding their top sub_bucket_bits bits, so every value is known
+//  within a relative error of 2^(1 - sub_bucket_bits) from a fixed number of counters
+struct latency_histogram_type {
+  static auto constexpr sub_bucket_bits = 7;
+  static auto constexpr sub_bucket_count = std::size_t {1} << sub_bucket_bits;
+  static auto constexpr half_sub_bucket_count = sub_bucket_count / 2;
+  static auto constexpr bucket_count = sub_bucket_count + (64 - sub_bucket_bits) * half_sub_bucket_count;
+
+  void record(std::uint64_t const latency_ns) {
+    if (counts.empty()) {
+      counts.resize(bucket_count);
+    }
+    ++counts[get_bucket_index(latency_ns)];
+    ++count;
+    total_ns += latency_ns;
+    max_ns = std::max(max_ns, latency_ns);
+  }
+
+  void merge(latency_histogram_type const &other) {
+    if (other.count == 0) {
+      return;
+    }
+    if (counts.empty()) {
+      counts.resize(bucket_count);
+    }
+    for (std::size_t bucket_index = 0; bucket_index < bucket_count; ++bucket_index) {
+      counts[bucket_index] += other.counts[bucket_index];
+    }
+    count += other.count;
+    total_ns += other.total_ns;
+    max_ns = std::max(max_ns, other.max_ns);
+  }
+
+  void clear() {
+    std::ranges::fill(counts, 0);
+    count = 0;
+    total_ns = 0;
+    max_ns = 0;
+  }
+
+  [[nodiscard]] std::uint64_t get_count() const {
+    return count;
+  }
+
+  [[nodiscard]] std::uint64_t get_max() const {
+    return max_ns;
+  }
+
+  [[nodiscard]] double get_mean() const {
+    return count == 0 ? 0 : static_cast<double>(total_ns) / static_cast<double>(count);
+  }
+
+  //  the highest value of the bucket holding the value at percentile, so never below the exact value
+  [[nodiscard]] std::uint64_t get_value_at_percentile(double const percentile) const {
+    if (count == 0) {
+      return 0;
+    }
+
+    auto const rank = std::max<std::uint64_t>(
+      1, static_cast<std::uint64_t>(std::ceil(percentile / 100 * static_cast<double>(count)))
+    );
+    std::uint64_t counted = 0;
+    for (std::size_t bucket_index = 0; bucket_index < bucket_count; ++bucket_index) {
+      counted += counts[bucket_index];
+      if (counted >= rank) {
+        return std::min(get_highest_equivalent_value(bucket_index), max_ns);
+      }
+    }
+    return max_ns;
+  }
+
+  private:
+  static std::size_t get_bucket_index(std::uint64_t const value) {
+    if (value < sub_bucket_count) {
+      return static_cast<std::size_t>(value);
+    }
+    //  shifts the leading one to bit sub_bucket_bits - 1
+    auto const shift = static_cast<std::size_t>(std::bit_width(value)) - sub_bucket_bits;
+    return sub_bucket_count
+      + (shift - 1) * half_sub_bucket_count
+      + static_cast<std::size_t>(value >> shift) - half_sub_bucket_count;
+  }
+
+  static std::uint64_t get_highest_equivalent_value(std::size_t const bucket_index) {
+    if (bucket_index < sub_bucket_count) {
+      return bucket_index;
+    }
+    auto const shift = (bucket_index - sub_bucket_count) / half_sub_bucket_count + 1;
+    auto const top_bits = std::uint64_t {(bucket_index - sub_bucket_count) % half_sub_bucket_count + half_sub_bucket_count};
+    return ((top_bits + 1) << shift) - 1;
+  }
+
+  //  empty until the first value, so unused histograms take no memory
+  std::vector<std::uint64_t> counts;
+  std::uint64_t count = 0;
+  std::uint64_t total_ns = 0;
+  std::uint64_t max_ns = 0;
+};
+
+inline std::uint64_t get_elapsed_ns(std::chrono::steady_clock::time_point const start) {
+  return static_cast<std::uint64_t>(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count()
+  );
+}
+
+//  solve latencies by people count, recorded by one thread without locking
+struct solve_metrics_type {
+  void record(std::size_t const people_count, std::uint64_t const latency_ns) {
+    if (people_count >= latencies_by_people_count.size()) {
+      latencies_by_people_count.resize(people_count + 1);
+    }
+    latencies_by_people_count[people_count].record(latency_ns);
+  }
+
+  void merge(solve_metrics_type const &other) {
+    if (other.latencies_by_people_count.size() > latencies_by_people_count.size()) {
+      latencies_by_people_count.resize(other.latencies_by_people_count.size());
+    }
+    for (std::size_t people_count = 0; people_count < other.latencies_by_people_count.size(); ++people_count) {
+      latencies_by_people_count[people_count].merge(other.latencies_by_people_count[people_count]);
+    }
+  }
+
+  void clear() {
+    for (auto &latencies : latencies_by_people_count) {
+      latencies.clear();
+    }
+  }
+
+  //  indexed by people count
+  std::vector<latency_histogram_type> latencies_by_people_count;
+};
+
+//  the solve_metrics_type of every thread of a run, merged as the threads pass them in, for reports
+//  at the end of the run or periodically while it runs.
+//
+//  states per second counts the 2^(n + 1) - 2 states of the state space of every instance, a measure
+//  of instance size that is the same whichever solver ran, rather than the states a solver expanded.
+struct solve_metrics_collector_type {
+  //  merges local, which the recording thread then clears and reuses
+  void add(solve_metrics_type const &local) {
+    std::scoped_lock const lock {metrics_mutex};
+    metrics.merge(local);
+  }
+
+  void write_report(std::ostream &output) const {
+    std::scoped_lock const lock {metrics_mutex};
+
+    auto const elapsed_seconds = std::chrono::duration<double> {std::chrono::steady_clock::now() - start}.count();
+    auto const get_rate = [&](double const amount) {
+      return elapsed_seconds > 0 ? amount / elapsed_seconds : 0;
+    };
+
+    std::uint64_t instance_count = 0;
+    double state_count = 0;
+    std::string people_counts;
+
+    for (std::size_t people_count = 0; people_count < metrics.latencies_by_people_count.size(); ++people_count) {
+      auto const &latencies = metrics.latencies_by_people_count[people_count];
+      if (latencies.get_count() == 0) {
+        continue;
+      }
+
+      auto const people_count_state_count = static_cast<double>(latencies.get_count())
+        * static_cast<double>((std::uint64_t {1} << (people_count + 1)) - 2);
+      instance_count += latencies.get_count();
+      state_count += people_count_state_count;
+
+      people_counts += std::format(
+        "{}\n{{\"people_count\":{},\"instance_count\":{},\"instances_per_second\":{:.1f},"
+        "\"states_per_second\":{:.1f},\"mean_ns\":{:.1f},\"p50_ns\":{},\"p99_ns\":{},\"p999_ns\":{},\"max_ns\":{}}}",
+        people_counts.empty() ? "" : ",",
+        people_count, latencies.get_count(), get_rate(static_cast<double>(latencies.get_count())),
+        get_rate(people_count_state_count), latencies.get_mean(),
+        latencies.get_value_at_percentile(50), latencies.get_value_at_percentile(99),
+        latencies.get_value_at_percentile(99.9), latencies.get_max()
+      );
+    }
+
+    output << std::format(
+      "{{\"elapsed_seconds\":{:.3f},\"instance_count\":{},\"instances_per_second\":{:.1f},"
+      "\"states_per_second\":{:.1f},\"people_counts\":[{}\n]}}\n",
+      elapsed_seconds, instance_count, get_rate(static_cast<double>(instance_count)), get_rate(state_count),
+      people_counts
+    );
+  }
+
+  private:
+  std::chrono::steady_clock::time_point const start = std::chrono::steady_clock::now();
+  mutable std::mutex metrics_mutex;
+  solve_metrics_type metrics;
+};
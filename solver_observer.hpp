@@ -0,0 +1,80 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "bridge_state.hpp"
+
+//  solvers taking an observer call it as they search, naming states by state_repr so the callbacks mean
+//  the same whatever the graph representation:
+//    on_pop(state_repr, distance, frontier_size): a label is expanded. stale labels are skipped first.
+//    on_relax(state_repr, crossed_state_repr, distance): a crossing is tried, arriving at distance.
+//    on_improve(state_repr, crossed_state_repr, distance): the crossing improved crossed_state_repr.
+//    on_goal(state_repr, distance): the state the search stops at, usually the end state, is settled.
+//  the default null_solver_observer_type does nothing, and with it the solvers compile to the same
+//  loops as without hooks.
+struct null_solver_observer_type {
+  using int_value_type = bridge_state_type::int_value_type;
+
+  void on_pop(int_value_type, auto, std::size_t) const {
+  }
+
+  void on_relax(int_value_type, int_value_type, auto) const {
+  }
+
+  void on_improve(int_value_type, int_value_type, auto) const {
+  }
+
+  void on_goal(int_value_type, auto) const {
+  }
+};
+
+//  the people across of a state_repr, which every crossing changes by one or two
+inline std::size_t get_crossed_people_count(bridge_state_type::int_value_type const state_repr) {
+  //  leaves out the leading one and the torch bit
+  return static_cast<std::size_t>(std::popcount(state_repr)) - 1 - (state_repr & 1);
+}
+
+//  expansions, improvements and the largest frontier seen, per people across of the expanded state
+struct layer_counting_observer_type {
+  using int_value_type = bridge_state_type::int_value_type;
+
+  struct layer_counts_type {
+    std::uint64_t pop_count;
+    std::uint64_t relax_count;
+    std::uint64_t improve_count;
+    std::size_t max_frontier_size;
+  };
+
+  void on_pop(int_value_type const state_repr, auto, std::size_t const frontier_size) {
+    auto &layer = get_layer(state_repr);
+    ++layer.pop_count;
+    layer.max_frontier_size = std::max(layer.max_frontier_size, frontier_size);
+  }
+
+  void on_relax(int_value_type const state_repr, int_value_type, auto) {
+    ++get_layer(state_repr).relax_count;
+  }
+
+  void on_improve(int_value_type const state_repr, int_value_type, auto) {
+    ++get_layer(state_repr).improve_count;
+  }
+
+  void on_goal(int_value_type, auto) const {
+  }
+
+  //  indexed by crossed people count
+  std::vector<layer_counts_type> layers;
+
+  private:
+  layer_counts_type &get_layer(int_value_type const state_repr) {
+    auto const layer_index = get_crossed_people_count(state_repr);
+    if (layer_index >= layers.size()) {
+      layers.resize(layer_index + 1, {.pop_count = 0, .relax_count = 0, .improve_count = 0, .max_frontier_size = 0});
+    }
+    return layers[layer_index];
+  }
+};
@@ -0,0 +1,300 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <format>
+#include <functional>
+#include <map>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "bridge_state.hpp"
+#include "memory_tracking.hpp"
+#include "tracing.hpp"
+
+using states_list_type = tracked_vector_type<bridge_state_type, memory_category_type::states>;
+using state_to_index_map_type = std::map<
+  bridge_state_type::int_value_type,
+  std::size_t,
+  std::less<bridge_state_type::int_value_type>,
+  tracked_allocator_type<std::pair<bridge_state_type::int_value_type const, std::size_t>, memory_category_type::state_index_map>
+>;
+
+//  build_state_graph always places the start and end states first
+auto constexpr start_state_index = std::size_t {0};
+auto constexpr end_state_index = std::size_t {1};
+
+inline void try_add_or_connect_crossed_state(
+  states_list_type &states,
+  state_to_index_map_type &state_to_states_index,
+  std::size_t &connection_count,
+  std::size_t const curr_state_index,
+  bridge_state_type &&crossed_state,
+  time_to_cross_type const time_to_cross
+) {
+  auto create_connection = false;
+  auto const crossed_state_index_iter = state_to_states_index.find(crossed_state.state_repr);
+  std::size_t crossed_state_index;
+
+  if (crossed_state_index_iter == state_to_states_index.end()) {
+    create_connection = true;
+    crossed_state_index = states.size();
+    state_to_states_index.insert_or_assign(crossed_state.state_repr, crossed_state_index);
+    states.emplace_back(std::move(crossed_state));
+  } else if (crossed_state_index_iter->second > curr_state_index) {
+    create_connection = true;
+    crossed_state_index = crossed_state_index_iter->second;
+  }
+
+  if (!create_connection) {
+    return;
+  }
+
+  ++connection_count;
+  states.at(curr_state_index).possible_crossings.emplace_back(
+    bridge_state_type::crossing_type {
+      .state_index_after_crossing = crossed_state_index,
+      .time_to_cross = time_to_cross
+    }
+  );
+  states.at(crossed_state_index).possible_crossings.emplace_back(
+    bridge_state_type::crossing_type {
+      .state_index_after_crossing = curr_state_index,
+      .time_to_cross = time_to_cross
+    }
+  );
+}
+
+inline states_list_type build_state_graph(std::vector<time_to_cross_type> const &times_to_cross) {
+  ROPE_BRIDGE_TRACE_SPAN_ARG("build_state_graph", times_to_cross.size());
+  auto const people_count = times_to_cross.size();
+  auto const max_possible_states = (1 << people_count + 1) - 2;
+
+  states_list_type states;
+  states.reserve(max_possible_states);
+
+  {
+    state_to_index_map_type state_to_states_index;
+
+    {
+      auto start_state = bridge_state_type::start(people_count);
+      state_to_states_index.insert_or_assign(start_state.state_repr, states.size());
+      states.emplace_back(std::move(start_state));
+
+      auto end_state = bridge_state_type::end(people_count);
+      state_to_states_index.insert_or_assign(end_state.state_repr, states.size());
+      states.emplace_back(std::move(end_state));
+    }
+
+    std::size_t connection_count = 0;
+
+    for (
+      decltype(states)::size_type curr_state_index = 0;
+      curr_state_index < states.size();
+      ++curr_state_index
+    ) {
+      auto const curr_state_copy = states.at(curr_state_index);
+      auto const possible_crosser_indices =  curr_state_copy.get_possible_crosser_indices();
+
+      // iterate single crosser
+      {
+        std::size_t single_crosser_index = 0;
+
+        for (
+          auto iterated_possible_crosser_indices = possible_crosser_indices;
+          iterated_possible_crosser_indices != 0;
+          ++single_crosser_index, iterated_possible_crosser_indices >>= 1
+        ) {
+          if ((iterated_possible_crosser_indices & 1) == 0) {
+            continue;
+          }
+
+          assert(single_crosser_index < people_count);
+
+          try_add_or_connect_crossed_state(
+            states,
+            state_to_states_index,
+            connection_count,
+            curr_state_index,
+            bridge_state_type::after_single_crossing<hot_path_bridge_state_checking>(curr_state_copy, single_crosser_index),
+            times_to_cross.at(single_crosser_index)
+          );
+        }
+      }
+
+      // iterate double crossers
+      {
+        std::size_t first_crosser_index = 0;
+
+        for (
+          auto first_crosser_iterated_possible_crosser_indices = possible_crosser_indices;
+          first_crosser_iterated_possible_crosser_indices != 0;
+          ++first_crosser_index, first_crosser_iterated_possible_crosser_indices >>= 1
+        ) {
+          if ((first_crosser_iterated_possible_crosser_indices & 1) == 0) {
+            continue;
+          }
+
+          assert(first_crosser_index < people_count);
+
+          auto second_crosser_index = first_crosser_index + 1;
+
+          for (
+            auto second_crosser_iterated_possible_crosser_indices
+              = first_crosser_iterated_possible_crosser_indices >> 1;
+            second_crosser_iterated_possible_crosser_indices != 0;
+            ++second_crosser_index, second_crosser_iterated_possible_crosser_indices >>= 1
+          ) {
+            if ((second_crosser_iterated_possible_crosser_indices & 1) == 0) {
+              continue;
+            }
+
+            assert(second_crosser_index < people_count);
+
+            try_add_or_connect_crossed_state(
+              states,
+              state_to_states_index,
+              connection_count,
+              curr_state_index,
+              bridge_state_type::after_double_crossing<hot_path_bridge_state_checking>(
+                curr_state_copy, first_crosser_index, second_crosser_index
+              ),
+              std::max(
+                times_to_cross.at(first_crosser_index),
+                times_to_cross.at(second_crosser_index)
+              )
+            );
+          }
+        }
+      }
+    }
+  }
+
+  return states;
+}
+
+//  extends a graph built for all but the last of times_to_cross to the graph for all of them, as
+//  build_state_graph(times_to_cross) would build it up to the order of states and crossings.
+//
+//  the new person takes the bit of the old leading one, so every old state appears twice: once with
+//  the new person before the bridge (state_repr + leading one) and once after it
+//  (state_repr + 2 * leading one), both keeping all old crossings. the existing states are re-encoded
+//  in place as the first copy and the second copy is appended, with the end state swapped to
+//  end_state_index. the only new crossings are the ones that include the new person, plus the two
+//  states the old people count could not reach: everyone old across and the new person before the
+//  bridge with the torch, and the mirror of that, the new person across with the torch and everyone
+//  old before the bridge.
+inline void extend_state_graph(states_list_type &states, std::vector<time_to_cross_type> const &times_to_cross) {
+  ROPE_BRIDGE_TRACE_SPAN_ARG("extend_state_graph", times_to_cross.size());
+  auto const old_people_count = states.at(start_state_index).get_people_count();
+  if (times_to_cross.size() != old_people_count + 1) {
+    throw std::invalid_argument(std::format(
+      "times_to_cross size is out of range. is {}. should be {}.",
+      times_to_cross.size(), old_people_count + 1
+    ));
+  }
+  //  validates the new people count
+  auto const new_end_state = bridge_state_type::end(times_to_cross.size());
+
+  auto const old_state_count = states.size();
+  auto const old_leading_one = bridge_state_type::start(old_people_count).state_repr;
+  auto constexpr no_state_index = static_cast<std::size_t>(-1);
+
+  std::vector<std::size_t> old_state_index_by_repr(old_leading_one, no_state_index);
+  for (std::size_t state_index = 0; state_index < old_state_count; ++state_index) {
+    old_state_index_by_repr.at(states.at(state_index).state_repr - old_leading_one) = state_index;
+  }
+
+  auto const new_person_before_index = [&](std::size_t const old_state_index) {
+    return old_state_index == end_state_index ? old_state_count + end_state_index : old_state_index;
+  };
+  auto const new_person_after_index = [&](std::size_t const old_state_index) {
+    return old_state_index == end_state_index ? end_state_index : old_state_count + old_state_index;
+  };
+  auto const everyone_old_after_index = 2 * old_state_count;
+  auto const everyone_old_before_index = 2 * old_state_count + 1;
+
+  states.reserve(2 * old_state_count + 2);
+  for (std::size_t state_index = 0; state_index < old_state_count; ++state_index) {
+    states.push_back(states.at(state_index));
+  }
+
+  for (std::size_t state_index = 0; state_index < old_state_count; ++state_index) {
+    auto &new_person_before_state = states.at(state_index);
+    new_person_before_state.state_repr += old_leading_one;
+    for (auto &crossing : new_person_before_state.possible_crossings) {
+      crossing.state_index_after_crossing = new_person_before_index(crossing.state_index_after_crossing);
+    }
+
+    auto &new_person_after_state = states.at(old_state_count + state_index);
+    new_person_after_state.state_repr += 2 * old_leading_one;
+    for (auto &crossing : new_person_after_state.possible_crossings) {
+      crossing.state_index_after_crossing = new_person_after_index(crossing.state_index_after_crossing);
+    }
+  }
+  std::swap(states.at(end_state_index), states.at(old_state_count + end_state_index));
+
+  states.push_back({.state_repr = new_end_state.state_repr ^ old_leading_one ^ 1});
+  states.push_back({.state_repr = bridge_state_type::start(times_to_cross.size()).state_repr ^ old_leading_one ^ 1});
+
+  auto const connect = [&](
+    std::size_t const first_state_index,
+    std::size_t const second_state_index,
+    time_to_cross_type const time_to_cross
+  ) {
+    states.at(first_state_index).possible_crossings.push_back({
+      .state_index_after_crossing = second_state_index,
+      .time_to_cross = time_to_cross
+    });
+    states.at(second_state_index).possible_crossings.push_back({
+      .state_index_after_crossing = first_state_index,
+      .time_to_cross = time_to_cross
+    });
+  };
+
+  auto const new_time_to_cross = times_to_cross.back();
+  connect(everyone_old_after_index, end_state_index, new_time_to_cross);
+
+  for (std::size_t old_state_index = 0; old_state_index < old_state_count; ++old_state_index) {
+    //  the copies were re-encoded, so the old state is rebuilt from the copy before the bridge
+    bridge_state_type const old_state {
+      .state_repr = states.at(new_person_before_index(old_state_index)).state_repr - old_leading_one
+    };
+    if (old_state.get_torch_crossed()) {
+      continue;
+    }
+
+    auto const old_torch_crossed_index = old_state_index_by_repr.at((old_state.state_repr ^ 1) - old_leading_one);
+    connect(
+      new_person_before_index(old_state_index),
+      old_torch_crossed_index == no_state_index
+        ? everyone_old_before_index
+        : new_person_after_index(old_torch_crossed_index),
+      new_time_to_cross
+    );
+
+    auto const possible_crosser_indices = old_state.get_possible_crosser_indices();
+    std::size_t crosser_index = 0;
+
+    for (
+      auto iterated_possible_crosser_indices = possible_crosser_indices;
+      iterated_possible_crosser_indices != 0;
+      ++crosser_index, iterated_possible_crosser_indices >>= 1
+    ) {
+      if ((iterated_possible_crosser_indices & 1) == 0) {
+        continue;
+      }
+
+      auto const crossed_old_state = bridge_state_type::after_single_crossing<hot_path_bridge_state_checking>(
+        old_state, crosser_index
+      );
+      connect(
+        new_person_before_index(old_state_index),
+        new_person_after_index(old_state_index_by_repr.at(crossed_old_state.state_repr - old_leading_one)),
+        std::max(new_time_to_cross, times_to_cross.at(crosser_index))
+      );
+    }
+  }
+}
@@ -0,0 +1,525 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "bridge_state.hpp"
+#include "shortest_path.hpp"
+#include "state_graph.hpp"
+
+//  a person's crossing time as a random variable, sampled through its quantile function.
+//  negative quantiles of normal distributions are clamped to zero.
+struct crossing_time_distribution_type {
+  enum class kind_type {
+    constant,
+    uniform,
+    normal,
+    log_normal,
+    shifted_exponential
+  };
+
+  static crossing_time_distribution_type constant(double const time_to_cross) {
+    return {.kind = kind_type::constant, .first_parameter = time_to_cross, .second_parameter = 0};
+  }
+
+  static crossing_time_distribution_type uniform(double const min_time, double const max_time) {
+    validate_parameter_order(min_time, max_time);
+    return {.kind = kind_type::uniform, .first_parameter = min_time, .second_parameter = max_time};
+  }
+
+  static crossing_time_distribution_type normal(double const mean, double const standard_deviation) {
+    validate_parameter_order(0, standard_deviation);
+    return {.kind = kind_type::normal, .first_parameter = mean, .second_parameter = standard_deviation};
+  }
+
+  //  exp of a normal variable with the given mean and standard deviation
+  static crossing_time_distribution_type log_normal(double const log_mean, double const log_standard_deviation) {
+    validate_parameter_order(0, log_standard_deviation);
+    return {
+      .kind = kind_type::log_normal,
+      .first_parameter = log_mean,
+      .second_parameter = log_standard_deviation
+    };
+  }
+
+  static crossing_time_distribution_type shifted_exponential(double const min_time, double const mean_delay) {
+    validate_parameter_order(0, mean_delay);
+    return {.kind = kind_type::shifted_exponential, .first_parameter = min_time, .second_parameter = mean_delay};
+  }
+
+  [[nodiscard]] double get_quantile(double const probability) const {
+    switch (kind) {
+      case kind_type::constant:
+        return first_parameter;
+      case kind_type::uniform:
+        return first_parameter + probability * (second_parameter - first_parameter);
+      case kind_type::normal:
+        return std::max(0.0, first_parameter + second_parameter * get_standard_normal_quantile(probability));
+      case kind_type::log_normal:
+        return std::exp(first_parameter + second_parameter * get_standard_normal_quantile(probability));
+      case kind_type::shifted_exponential:
+        return first_parameter - second_parameter * std::log1p(-probability);
+    }
+    return first_parameter;
+  }
+
+  kind_type kind;
+  double first_parameter;
+  double second_parameter;
+
+  private:
+  static void validate_parameter_order(double const lower, double const upper) {
+    if (!(upper >= lower)) {
+      throw std::invalid_argument(std::format(
+        "distribution parameter is out of range. is {}. should be at least {}.",
+        upper, lower
+      ));
+    }
+  }
+
+  //  Acklam's rational approximation, relative error below 1.2e-9
+  static double get_standard_normal_quantile(double const probability) {
+    static double constexpr a[] = {
+      -3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02,
+      1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00
+    };
+    static double constexpr b[] = {
+      -5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02,
+      6.680131188771972e+01, -1.328068155288572e+01
+    };
+    static double constexpr c[] = {
+      -7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+      -2.549671010229528e+00, 4.374664141464968e+00, 2.938163982698783e+00
+    };
+    static double constexpr d[] = {
+      7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00, 3.754408661907416e+00
+    };
+    static double constexpr low_tail = 0.02425;
+
+    auto const tail = [&](double const tail_probability) {
+      auto const q = std::sqrt(-2 * std::log(tail_probability));
+      return (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5])
+        / ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1);
+    };
+
+    if (probability < low_tail) {
+      return tail(probability);
+    }
+    if (probability > 1 - low_tail) {
+      return -tail(1 - probability);
+    }
+
+    auto const q = probability - 0.5;
+    auto const r = q * q;
+    return (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q
+      / (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1);
+  }
+};
+
+//  draws every person's crossing time for a range of scenarios. each distribution is tabulated once
+//  into quantile_table_size equal probability steps, so a draw is a counter-based hash, a table
+//  lookup and a linear interpolation with no branching on the distribution kind. a scenario's draws
+//  only depend on the seed and the scenario index, so any batch split gives the same results.
+struct crossing_time_sampler_type {
+  static auto constexpr quantile_table_size = std::size_t {1024};
+
+  static crossing_time_sampler_type from_distributions(
+    std::vector<crossing_time_distribution_type> const &distributions,
+    std::uint32_t const seed
+  ) {
+    crossing_time_sampler_type result {.people_count = distributions.size(), .seed = seed, .quantile_tables = {}};
+    result.quantile_tables.reserve(distributions.size() * (quantile_table_size + 1));
+
+    //  the open ends of unbounded distributions are cut half a step in
+    for (auto const &distribution : distributions) {
+      for (std::size_t step = 0; step <= quantile_table_size; ++step) {
+        auto const probability = std::clamp(
+          static_cast<double>(step) / quantile_table_size,
+          0.5 / quantile_table_size,
+          1 - 0.5 / quantile_table_size
+        );
+        result.quantile_tables.push_back(static_cast<float>(distribution.get_quantile(probability)));
+      }
+    }
+
+    return result;
+  }
+
+  //  writes the time of person p in scenario first_scenario + l to times[p * stride + l]
+  void sample(
+    std::uint64_t const first_scenario,
+    std::size_t const scenario_count,
+    float *const times,
+    std::size_t const stride
+  ) const {
+    for (std::size_t person_index = 0; person_index < people_count; ++person_index) {
+      auto const *const table = quantile_tables.data() + person_index * (quantile_table_size + 1);
+      auto *const person_times = times + person_index * stride;
+      auto const person_key = mix(seed ^ mix(static_cast<std::uint32_t>(person_index) + 0x9e3779b9u));
+
+      for (std::size_t lane = 0; lane < scenario_count; ++lane) {
+        auto const bits = mix(person_key ^ static_cast<std::uint32_t>(first_scenario + lane));
+        auto const position = static_cast<float>(bits >> 8) * (quantile_table_size / 16777216.0f);
+        auto const step = static_cast<std::uint32_t>(position);
+        auto const fraction = position - static_cast<float>(step);
+        person_times[lane] = table[step] + fraction * (table[step + 1] - table[step]);
+      }
+    }
+  }
+
+  //  the least and the greatest time person_index can be drawn with
+  [[nodiscard]] double get_min_time(std::size_t const person_index) const {
+    return std::ranges::min(get_quantile_table(person_index));
+  }
+
+  [[nodiscard]] double get_max_time(std::size_t const person_index) const {
+    return std::ranges::max(get_quantile_table(person_index));
+  }
+
+  std::size_t people_count;
+  std::uint32_t seed;
+  std::vector<float> quantile_tables;
+
+  private:
+  [[nodiscard]] std::span<float const> get_quantile_table(std::size_t const person_index) const {
+    return std::span {quantile_tables}.subspan(person_index * (quantile_table_size + 1), quantile_table_size + 1);
+  }
+
+  static std::uint32_t mix(std::uint32_t value) {
+    value ^= value >> 16;
+    value *= 0x7feb352du;
+    value ^= value >> 15;
+    value *= 0x846ca68bu;
+    value ^= value >> 16;
+    return value;
+  }
+};
+
+//  the crossers of one step of a schedule. a single crosser is stored as both crossers.
+struct stochastic_step_type {
+  std::size_t first_crosser_index;
+  std::size_t second_crosser_index;
+};
+
+inline stochastic_step_type get_stochastic_step(
+  bridge_state_type const &prior_state,
+  bridge_state_type const &crossed_state
+) {
+  auto const crossers = (prior_state.state_repr ^ crossed_state.state_repr) >> 1;
+  auto const first_crosser_index = static_cast<std::size_t>(__builtin_ctz(crossers));
+  auto const remaining_crossers = crossers & (crossers - 1);
+
+  return {
+    .first_crosser_index = first_crosser_index,
+    .second_crosser_index = remaining_crossers == 0
+      ? first_crosser_index
+      : static_cast<std::size_t>(__builtin_ctz(remaining_crossers))
+  };
+}
+
+inline std::vector<stochastic_step_type> get_stochastic_steps(
+  states_list_type const &states,
+  std::vector<std::size_t> const &state_indices
+) {
+  if (state_indices.empty() || state_indices.front() != start_state_index) {
+    throw std::invalid_argument("schedule is out of range. should begin at the start state.");
+  }
+
+  std::vector<stochastic_step_type> result;
+  result.reserve(state_indices.size() - 1);
+
+  for (std::size_t step_index = 1; step_index < state_indices.size(); ++step_index) {
+    auto const &prior_state = states.at(state_indices.at(step_index - 1));
+    auto const crossed_state_index = state_indices.at(step_index);
+
+    if (std::ranges::none_of(prior_state.possible_crossings, [&](auto const &crossing) {
+      return crossing.state_index_after_crossing == crossed_state_index;
+    })) {
+      throw std::invalid_argument(std::format(
+        "schedule step {} is out of range. is {}. should be a possible crossing from {}.",
+        step_index, as_bits(states.at(crossed_state_index)), as_bits(prior_state)
+      ));
+    }
+
+    result.push_back(get_stochastic_step(prior_state, states.at(crossed_state_index)));
+  }
+
+  return result;
+}
+
+//  totals[l] = the schedule's total time with person p crossing in times[p * stride + l]. each step is
+//  a lane-wise max and add over contiguous lanes, which the compiler vectorizes.
+inline void accumulate_stochastic_totals(
+  std::vector<stochastic_step_type> const &steps,
+  float const *const times,
+  std::size_t const stride,
+  std::size_t const scenario_count,
+  float *const totals
+) {
+  std::fill_n(totals, scenario_count, 0.0f);
+
+  for (auto const &step : steps) {
+    auto const *const first_times = times + step.first_crosser_index * stride;
+    auto const *const second_times = times + step.second_crosser_index * stride;
+
+    for (std::size_t lane = 0; lane < scenario_count; ++lane) {
+      totals[lane] += std::max(first_times[lane], second_times[lane]);
+    }
+  }
+}
+
+struct stochastic_summary_type {
+  std::size_t scenario_count;
+  double expected_time;
+  double median_time;
+  double p95_time;
+  double p99_time;
+};
+
+//  the nearest-rank quantile. reorders totals.
+inline double get_stochastic_quantile(std::vector<float> &totals, double const probability) {
+  auto const rank = static_cast<std::size_t>(std::ceil(probability * static_cast<double>(totals.size())));
+  auto const nth = totals.begin() + static_cast<std::ptrdiff_t>(std::clamp<std::size_t>(rank, 1, totals.size()) - 1);
+  std::ranges::nth_element(totals, nth);
+  return *nth;
+}
+
+//  reorders totals
+inline stochastic_summary_type summarize_stochastic_totals(std::vector<float> &totals) {
+  double sum = 0;
+  for (auto const total : totals) {
+    sum += total;
+  }
+
+  return {
+    .scenario_count = totals.size(),
+    .expected_time = sum / static_cast<double>(totals.size()),
+    .median_time = get_stochastic_quantile(totals, 0.5),
+    .p95_time = get_stochastic_quantile(totals, 0.95),
+    .p99_time = get_stochastic_quantile(totals, 0.99)
+  };
+}
+
+//  scenarios are drawn and evaluated this many at a time so the draws stay in cache regardless of the
+//  scenario count
+inline auto constexpr monte_carlo_batch_size = std::size_t {512};
+
+inline void validate_stochastic_arguments(
+  states_list_type const &states,
+  crossing_time_sampler_type const &sampler,
+  std::size_t const scenario_count
+) {
+  if (scenario_count == 0) {
+    throw std::invalid_argument(std::format(
+      "scenario_count is out of range. is {}. should be at least 1.", scenario_count
+    ));
+  }
+
+  if (auto const people_count = states.at(start_state_index).get_people_count(); people_count != sampler.people_count) {
+    throw std::invalid_argument(std::format(
+      "sampler people count is out of range. is {}. should be {}.",
+      sampler.people_count, people_count
+    ));
+  }
+}
+
+//  total time of every scenario of a schedule, given as the state indices it passes through from the
+//  start state, drawn and evaluated monte_carlo_batch_size scenarios at a time
+inline std::vector<float> sample_stochastic_totals(
+  states_list_type const &states,
+  std::vector<std::size_t> const &state_indices,
+  crossing_time_sampler_type const &sampler,
+  std::size_t const scenario_count
+) {
+  validate_stochastic_arguments(states, sampler, scenario_count);
+  auto const steps = get_stochastic_steps(states, state_indices);
+
+  std::vector<float> totals(scenario_count);
+  std::vector<float> batch_times(sampler.people_count * monte_carlo_batch_size);
+
+  for (std::size_t first_scenario = 0; first_scenario < scenario_count; first_scenario += monte_carlo_batch_size) {
+    auto const batch_size = std::min(monte_carlo_batch_size, scenario_count - first_scenario);
+    sampler.sample(first_scenario, batch_size, batch_times.data(), monte_carlo_batch_size);
+    accumulate_stochastic_totals(
+      steps, batch_times.data(), monte_carlo_batch_size, batch_size, totals.data() + first_scenario
+    );
+  }
+
+  return totals;
+}
+
+inline stochastic_summary_type evaluate_stochastic_schedule(
+  states_list_type const &states,
+  std::vector<std::size_t> const &state_indices,
+  crossing_time_sampler_type const &sampler,
+  std::size_t const scenario_count
+) {
+  auto totals = sample_stochastic_totals(states, state_indices, sampler, scenario_count);
+  return summarize_stochastic_totals(totals);
+}
+
+//  counts of values over bin_count equal bins of [min_value, max_value], for quantiles of more values
+//  than are worth keeping
+struct stochastic_histogram_type {
+  static auto constexpr bin_count = std::size_t {1024};
+
+  void add(float const value) {
+    auto const position = (static_cast<double>(value) - min_value) * bins_per_unit;
+    ++bin_value_counts[static_cast<std::size_t>(std::clamp(position, 0.0, static_cast<double>(bin_count - 1)))];
+    ++value_count;
+  }
+
+  //  the nearest-rank quantile, interpolated within its bin
+  [[nodiscard]] double get_quantile(double const probability) const {
+    auto const rank = std::clamp<std::uint64_t>(
+      static_cast<std::uint64_t>(std::ceil(probability * static_cast<double>(value_count))), 1, value_count
+    );
+    std::uint64_t prior_value_count = 0;
+    for (std::size_t bin_index = 0; bin_index < bin_count; ++bin_index) {
+      if (prior_value_count + bin_value_counts[bin_index] >= rank) {
+        auto const fraction = (static_cast<double>(rank - prior_value_count) - 0.5)
+          / static_cast<double>(bin_value_counts[bin_index]);
+        return bins_per_unit == 0 ? min_value : min_value + (static_cast<double>(bin_index) + fraction) / bins_per_unit;
+      }
+      prior_value_count += bin_value_counts[bin_index];
+    }
+    return min_value;
+  }
+
+  double min_value;
+  //  zero when every value is min_value
+  double bins_per_unit;
+  std::uint64_t value_count;
+  std::vector<std::uint64_t> bin_value_counts;
+};
+
+enum class stochastic_objective_type {
+  expected_time,
+  quantile_time
+};
+
+struct stochastic_schedule_type {
+  std::vector<std::size_t> state_indices;
+  double objective_time;
+  stochastic_summary_type summary;
+};
+
+//  a schedule for the expected or the given quantile of the total time over scenario_count common
+//  scenarios.
+//
+//  the expectation of a sum is the sum of the expectations even though a person's draw is shared by
+//  all of their crossings, so weighing each crossing by the sampled mean of its slowest crosser
+//  and running Dijkstra gives the exact sample optimum for the expected time. quantiles do not
+//  decompose, so for a quantile the schedules optimal for the mean and for the per-crossing quantile
+//  are both evaluated and the better one kept, which need not be the optimum.
+//
+//  the scenarios are drawn monte_carlo_batch_size at a time, adding to a sum and, for quantiles, a
+//  stochastic_histogram_type per pair of crossers, so memory does not grow with scenario_count beyond
+//  the totals of the candidates.
+inline stochastic_schedule_type solve_stochastic(
+  states_list_type const &states,
+  crossing_time_sampler_type const &sampler,
+  std::size_t const scenario_count,
+  stochastic_objective_type const objective,
+  double const quantile = 0.95
+) {
+  validate_stochastic_arguments(states, sampler, scenario_count);
+  auto const people_count = sampler.people_count;
+  auto const with_quantiles = objective == stochastic_objective_type::quantile_time;
+
+  //  crossing costs only depend on the crossers, so they are kept per pair, indexed by
+  //  first_crosser_index * people_count + second_crosser_index with first_crosser_index first
+  std::vector<double> crossing_sums(people_count * people_count);
+  std::vector<stochastic_histogram_type> crossing_histograms;
+  if (with_quantiles) {
+    crossing_histograms.resize(people_count * people_count);
+    for (std::size_t first_crosser_index = 0; first_crosser_index < people_count; ++first_crosser_index) {
+      for (auto second_crosser_index = first_crosser_index; second_crosser_index < people_count; ++second_crosser_index) {
+        //  the draws of a person stay within the ends of their quantile table
+        auto const min_value = std::max(
+          sampler.get_min_time(first_crosser_index), sampler.get_min_time(second_crosser_index)
+        );
+        auto const max_value = std::max(
+          sampler.get_max_time(first_crosser_index), sampler.get_max_time(second_crosser_index)
+        );
+        crossing_histograms[first_crosser_index * people_count + second_crosser_index] = {
+          .min_value = min_value,
+          .bins_per_unit = max_value > min_value ? stochastic_histogram_type::bin_count / (max_value - min_value) : 0,
+          .value_count = 0,
+          .bin_value_counts = std::vector<std::uint64_t>(stochastic_histogram_type::bin_count)
+        };
+      }
+    }
+  }
+
+  std::vector<float> batch_times(people_count * monte_carlo_batch_size);
+
+  for (std::size_t first_scenario = 0; first_scenario < scenario_count; first_scenario += monte_carlo_batch_size) {
+    auto const batch_size = std::min(monte_carlo_batch_size, scenario_count - first_scenario);
+    sampler.sample(first_scenario, batch_size, batch_times.data(), monte_carlo_batch_size);
+
+    for (std::size_t first_crosser_index = 0; first_crosser_index < people_count; ++first_crosser_index) {
+      auto const *const first_times = batch_times.data() + first_crosser_index * monte_carlo_batch_size;
+
+      for (auto second_crosser_index = first_crosser_index; second_crosser_index < people_count; ++second_crosser_index) {
+        auto const *const second_times = batch_times.data() + second_crosser_index * monte_carlo_batch_size;
+        auto const pair_index = first_crosser_index * people_count + second_crosser_index;
+
+        double sum = 0;
+        for (std::size_t lane = 0; lane < batch_size; ++lane) {
+          sum += std::max(first_times[lane], second_times[lane]);
+        }
+        crossing_sums[pair_index] += sum;
+
+        if (with_quantiles) {
+          for (std::size_t lane = 0; lane < batch_size; ++lane) {
+            crossing_histograms[pair_index].add(std::max(first_times[lane], second_times[lane]));
+          }
+        }
+      }
+    }
+  }
+
+  auto const get_pair_index = [&](std::size_t const curr_state_index, bridge_state_type::crossing_type const &crossing) {
+    auto const step = get_stochastic_step(states.at(curr_state_index), states.at(crossing.state_index_after_crossing));
+    return step.first_crosser_index * people_count + step.second_crosser_index;
+  };
+
+  std::vector<std::vector<std::size_t>> candidates;
+  candidates.push_back(solve_shortest_path(states, [&](std::size_t const curr_state_index, auto const &crossing) {
+    return crossing_sums[get_pair_index(curr_state_index, crossing)] / static_cast<double>(scenario_count);
+  }).state_indices);
+  if (with_quantiles) {
+    candidates.push_back(solve_shortest_path(states, [&](std::size_t const curr_state_index, auto const &crossing) {
+      return crossing_histograms[get_pair_index(curr_state_index, crossing)].get_quantile(quantile);
+    }).state_indices);
+  }
+
+  stochastic_schedule_type result {
+    .state_indices = {},
+    .objective_time = std::numeric_limits<double>::infinity(),
+    .summary = {}
+  };
+
+  for (auto &candidate : candidates) {
+    auto totals = sample_stochastic_totals(states, candidate, sampler, scenario_count);
+    auto const summary = summarize_stochastic_totals(totals);
+    auto const objective_time = objective == stochastic_objective_type::expected_time
+      ? summary.expected_time
+      : get_stochastic_quantile(totals, quantile);
+
+    if (objective_time < result.objective_time) {
+      result = {.state_indices = std::move(candidate), .objective_time = objective_time, .summary = summary};
+    }
+  }
+
+  return result;
+}
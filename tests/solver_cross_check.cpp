@@ -0,0 +1,700 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <optional>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "batch_pipeline.hpp"
+#include "bridge_state.hpp"
+#include "budgeted_state_graph.hpp"
+#include "certificate.hpp"
+#include "checkpoint.hpp"
+#include "dynamic_optimum.hpp"
+#include "engine_selection.hpp"
+#include "fixed_people_count.hpp"
+#include "frontier_search.hpp"
+#include "ida_star.hpp"
+#include "instance_file.hpp"
+#include "parametric.hpp"
+#include "query_service.hpp"
+#include "release_times.hpp"
+#include "schedule_validator.hpp"
+#include "sensitivity.hpp"
+#include "shortest_path.hpp"
+#include "solution_store.hpp"
+#include "solver_observer.hpp"
+#include "state_graph.hpp"
+#include "stochastic.hpp"
+#include "time_dependent.hpp"
+#include "work_stealing.hpp"
+#include "work_stealing_batch.hpp"
+
+//  cross-checks the solvers against solve_fixed on small random instances. each check is a ctest test
+//  of its own, run by passing its name; without arguments every check runs.
+
+namespace {
+  auto constexpr instance_count = 200;
+
+  //  random instances, seeded the same for every check so a failure reproduces
+  struct instance_generator_type {
+    std::vector<time_to_cross_type> get_times(
+      std::size_t const min_people_count,
+      std::size_t const max_people_count,
+      time_to_cross_type const max_time = 100
+    ) {
+      std::uniform_int_distribution<std::size_t> people_count_distribution {min_people_count, max_people_count};
+      std::uniform_int_distribution<time_to_cross_type> time_distribution {1, max_time};
+      std::vector<time_to_cross_type> result(people_count_distribution(generator));
+      std::ranges::generate(result, [&] { return time_distribution(generator); });
+      return result;
+    }
+
+    std::mt19937 generator {1};
+  };
+
+  std::string format_times(std::span<time_to_cross_type const> const times_to_cross) {
+    std::string result;
+    for (auto const time_to_cross : times_to_cross) {
+      result += std::format("{}{}", result.empty() ? "" : " ", time_to_cross);
+    }
+    return result;
+  }
+
+  void expect(bool const condition, std::string_view const what, std::span<time_to_cross_type const> const times_to_cross) {
+    if (!condition) {
+      throw std::runtime_error(std::format("{} for times [{}]", what, format_times(times_to_cross)));
+    }
+  }
+
+  //  state_reprs is a legal schedule of times_to_cross from the start state to the end state taking total_time
+  template <typename state_repr_type>
+  void expect_schedule(
+    std::vector<time_to_cross_type> const &times_to_cross,
+    std::vector<state_repr_type> const &state_reprs,
+    std::int64_t const total_time
+  ) {
+    std::vector<schedule_validator_type::crosser_mask_type> crosser_masks;
+    for (std::size_t step_index = 1; step_index < state_reprs.size(); ++step_index) {
+      crosser_masks.push_back(static_cast<schedule_validator_type::crosser_mask_type>(
+        (state_reprs.at(step_index - 1) ^ state_reprs.at(step_index)) >> 1
+      ));
+    }
+    auto const validation = schedule_validator_type::from_times(times_to_cross).validate(crosser_masks);
+
+    expect(
+      !state_reprs.empty() && state_reprs.front() == bridge_state_type::start(times_to_cross.size()).state_repr,
+      "schedule does not leave from the start state", times_to_cross
+    );
+    expect(validation.violation == schedule_violation_type::none, "schedule is not legal", times_to_cross);
+    expect(validation.total_time == total_time, "schedule does not take its total time", times_to_cross);
+  }
+
+  //  solve_with_release_times with no one held back is solve_fixed, and holding people back costs at
+  //  most the latest release
+  void check_release_times() {
+    instance_generator_type instances;
+    for (auto instance_index = 0; instance_index < instance_count; ++instance_index) {
+      auto const times_to_cross = instances.get_times(1, 10);
+      auto const optimum = solve_fixed(times_to_cross).total_time;
+
+      auto const unreleased = solve_with_release_times(times_to_cross, std::vector<time_to_cross_type>(times_to_cross.size()));
+      expect(unreleased.total_time == optimum, "release times of 0 change the optimum", times_to_cross);
+
+      auto const release_times = instances.get_times(times_to_cross.size(), times_to_cross.size());
+      auto const released = solve_with_release_times(times_to_cross, release_times);
+      expect(
+        released.total_time >= optimum && released.total_time <= optimum + std::ranges::max(release_times),
+        "release times move the optimum out of [optimum, optimum + latest release]", times_to_cross
+      );
+    }
+  }
+
+  //  solve_time_dependent with constant times is solve_fixed, at any start time
+  void check_time_dependent() {
+    instance_generator_type instances;
+    for (auto instance_index = 0; instance_index < instance_count; ++instance_index) {
+      auto const times_to_cross = instances.get_times(1, 9);
+      auto const optimum = solve_fixed(times_to_cross).total_time;
+      auto const states = build_state_graph(times_to_cross);
+      auto const constant_times = time_dependent_times_to_cross_type::constant(times_to_cross);
+
+      expect(
+        solve_time_dependent(states, constant_times).total_time == optimum,
+        "constant time-dependent times change the optimum", times_to_cross
+      );
+
+      auto const later = solve_time_dependent(states, constant_times, 50);
+      std::vector<bridge_state_type::int_value_type> state_reprs {states.at(start_state_index).state_repr};
+      for (auto const &crossing : later.crossings) {
+        state_reprs.push_back(states.at(crossing.state_index_after_crossing).state_repr);
+      }
+      expect_schedule(times_to_cross, state_reprs, optimum);
+      expect(
+        later.total_time == optimum && later.crossings.back().arrival_time == 50 + optimum,
+        "a later start with constant times does not shift the optimum", times_to_cross
+      );
+    }
+  }
+
+  //  solve_stochastic with every time constant has nothing to sample, so for either objective its
+  //  schedule is an optimum of solve_fixed
+  void check_stochastic() {
+    instance_generator_type instances;
+    for (auto instance_index = 0; instance_index < instance_count / 4; ++instance_index) {
+      auto const times_to_cross = instances.get_times(1, 8);
+      auto const optimum = solve_fixed(times_to_cross).total_time;
+      auto const states = build_state_graph(times_to_cross);
+
+      std::vector<crossing_time_distribution_type> distributions;
+      for (auto const time_to_cross : times_to_cross) {
+        distributions.push_back(crossing_time_distribution_type::constant(time_to_cross));
+      }
+      auto const sampler = crossing_time_sampler_type::from_distributions(distributions, 1);
+
+      for (auto const objective : {stochastic_objective_type::expected_time, stochastic_objective_type::quantile_time}) {
+        auto const schedule = solve_stochastic(states, sampler, 1000, objective);
+        std::vector<bridge_state_type::int_value_type> state_reprs;
+        for (auto const state_index : schedule.state_indices) {
+          state_reprs.push_back(states.at(state_index).state_repr);
+        }
+        expect_schedule(times_to_cross, state_reprs, optimum);
+        expect(
+          std::abs(schedule.summary.expected_time - optimum) < 1e-3 * optimum,
+          "constant stochastic times change the expected optimum", times_to_cross
+        );
+      }
+    }
+  }
+
+  //  dynamic_optimum_type follows solve_fixed as people are added and removed
+  void check_dynamic_optimum() {
+    instance_generator_type instances;
+    for (auto instance_index = 0; instance_index < instance_count; ++instance_index) {
+      auto times_to_cross = instances.get_times(1, 12);
+      dynamic_optimum_type optimum;
+      for (auto const time_to_cross : times_to_cross) {
+        optimum.insert(time_to_cross);
+      }
+      expect(optimum.get_total_time() == solve_fixed(times_to_cross).total_time, "insert misses the optimum", times_to_cross);
+
+      while (times_to_cross.size() > 1) {
+        auto const erased_index = instances.generator() % times_to_cross.size();
+        optimum.erase(times_to_cross.at(erased_index));
+        times_to_cross.erase(times_to_cross.begin() + static_cast<std::ptrdiff_t>(erased_index));
+        expect(optimum.get_total_time() == solve_fixed(times_to_cross).total_time, "erase misses the optimum", times_to_cross);
+      }
+    }
+  }
+
+  //  a graph grown by extend_state_graph one person at a time solves to the optimum of solve_fixed
+  void check_extend_state_graph() {
+    instance_generator_type instances;
+    for (auto instance_index = 0; instance_index < instance_count / 10; ++instance_index) {
+      auto const times_to_cross = instances.get_times(10, 10);
+      std::vector<time_to_cross_type> extended_times {times_to_cross.front()};
+      auto states = build_state_graph(extended_times);
+
+      for (auto const time_to_cross : std::span {times_to_cross}.subspan(1)) {
+        extended_times.push_back(time_to_cross);
+        extend_state_graph(states, extended_times);
+        expect(
+          states.size() == build_state_graph(extended_times).size()
+            && solve_shortest_path(states).total_time == solve_fixed(extended_times).total_time,
+          "extended graph misses the optimum", extended_times
+        );
+      }
+    }
+  }
+
+  //  the schedule of analyze_sensitivity takes the optimum of solve_fixed, and stays optimal when one
+  //  person's time moves to an end of their range
+  void check_sensitivity() {
+    instance_generator_type instances;
+    for (auto instance_index = 0; instance_index < instance_count / 4; ++instance_index) {
+      auto const times_to_cross = instances.get_times(1, 7);
+      auto const states = build_state_graph(times_to_cross);
+      auto const report = analyze_sensitivity(states, times_to_cross);
+      expect(report.total_time == solve_fixed(times_to_cross).total_time, "sensitivity misses the optimum", times_to_cross);
+
+      std::vector<bridge_state_type::int_value_type> state_reprs;
+      for (auto const state_index : report.state_indices) {
+        state_reprs.push_back(states.at(state_index).state_repr);
+      }
+
+      for (std::size_t person_index = 0; person_index < times_to_cross.size(); ++person_index) {
+        auto const &sensitivity = report.people.at(person_index);
+        expect(
+          sensitivity.min_time <= times_to_cross.at(person_index) && sensitivity.max_time >= times_to_cross.at(person_index),
+          "a range leaves out the person's own time", times_to_cross
+        );
+
+        for (auto const range_end : {std::ceil(sensitivity.min_time), std::floor(sensitivity.max_time)}) {
+          if (!std::isfinite(range_end) || range_end < 1) {
+            continue;
+          }
+          auto moved_times = times_to_cross;
+          moved_times.at(person_index) = static_cast<time_to_cross_type>(range_end);
+          expect_schedule(moved_times, state_reprs, solve_fixed(moved_times).total_time);
+        }
+      }
+    }
+  }
+
+  //  the curve of compute_optimum_curve gives the optimum of solve_fixed at every integer time of the
+  //  person it varies
+  void check_optimum_curve() {
+    instance_generator_type instances;
+    for (auto instance_index = 0; instance_index < instance_count / 4; ++instance_index) {
+      auto const times_to_cross = instances.get_times(2, 7, 30);
+      auto const states = build_state_graph(times_to_cross);
+      auto const person_index = instances.generator() % times_to_cross.size();
+      auto const curve = compute_optimum_curve(states, times_to_cross, person_index, 0, 40);
+
+      auto moved_times = times_to_cross;
+      for (time_to_cross_type time_to_cross = 0; time_to_cross <= 40; ++time_to_cross) {
+        moved_times.at(person_index) = time_to_cross;
+        //  the piece starts at the last breakpoint not past time_to_cross
+        auto const next_piece = std::ranges::upper_bound(
+          curve, static_cast<double>(time_to_cross), {}, &optimum_curve_breakpoint_type::time_to_cross
+        );
+        expect(next_piece != curve.begin(), "the optimum curve starts past its min_time", moved_times);
+        auto const &piece = *std::prev(next_piece);
+        expect(
+          piece.total_time + static_cast<double>(piece.slope) * (time_to_cross - piece.time_to_cross)
+            == solve_fixed(moved_times).total_time,
+          "the optimum curve misses the optimum", moved_times
+        );
+      }
+    }
+  }
+
+  //  make_optimality_certificate proves the optimum of solve_fixed, and raising its claim breaks it
+  void check_optimality_certificate() {
+    instance_generator_type instances;
+    for (auto instance_index = 0; instance_index < instance_count; ++instance_index) {
+      auto const times_to_cross = instances.get_times(1, 9);
+      auto const states = build_state_graph(times_to_cross);
+      auto certificate = make_optimality_certificate(states);
+
+      std::vector<bridge_state_type::int_value_type> state_reprs;
+      for (auto const state_index : certificate.state_indices) {
+        state_reprs.push_back(states.at(state_index).state_repr);
+      }
+      expect_schedule(times_to_cross, state_reprs, certificate.total_time);
+      expect(certificate.total_time == solve_fixed(times_to_cross).total_time, "a certificate misses the optimum", times_to_cross);
+      expect(!verify_optimality_certificate(states, certificate), "a certificate does not verify", times_to_cross);
+
+      ++certificate.total_time;
+      ++certificate.potentials.at(end_state_index);
+      expect(verify_optimality_certificate(states, certificate).has_value(), "a raised certificate verifies", times_to_cross);
+    }
+  }
+
+  //  schedule_validator_type agrees with the crossings of build_state_graph on random walks, which
+  //  mostly take real crossings and sometimes a random crosser mask
+  void check_schedule_validator() {
+    instance_generator_type instances;
+    for (auto instance_index = 0; instance_index < instance_count; ++instance_index) {
+      auto const times_to_cross = instances.get_times(1, 6);
+      auto const states = build_state_graph(times_to_cross);
+      auto const validator = schedule_validator_type::from_times(times_to_cross);
+      std::uniform_int_distribution<schedule_validator_type::crosser_mask_type> mask_distribution {
+        0, (schedule_validator_type::crosser_mask_type {2} << times_to_cross.size()) - 1
+      };
+
+      for (auto walk_index = 0; walk_index < 20; ++walk_index) {
+        std::vector<schedule_validator_type::crosser_mask_type> crosser_masks;
+        auto state_index = start_state_index;
+        std::int64_t total_time = 0;
+        std::optional<std::size_t> illegal_step_index;
+
+        for (std::size_t step_index = 0; step_index < 2 * times_to_cross.size() && state_index != end_state_index; ++step_index) {
+          auto const &possible_crossings = states.at(state_index).possible_crossings;
+          auto const crossing = possible_crossings.at(instances.generator() % possible_crossings.size());
+          auto const crosser_mask = instances.generator() % 8 == 0 ? mask_distribution(instances.generator)
+            : (states.at(state_index).state_repr ^ states.at(crossing.state_index_after_crossing).state_repr) >> 1;
+          crosser_masks.push_back(crosser_mask);
+
+          auto const taken = std::ranges::find_if(possible_crossings, [&](bridge_state_type::crossing_type const &other) {
+            return (states.at(state_index).state_repr ^ states.at(other.state_index_after_crossing).state_repr) >> 1 == crosser_mask;
+          });
+          if (taken == possible_crossings.end()) {
+            illegal_step_index = step_index;
+            break;
+          }
+          total_time += taken->time_to_cross;
+          state_index = taken->state_index_after_crossing;
+        }
+
+        auto const validation = validator.validate(crosser_masks);
+        if (illegal_step_index) {
+          expect(
+            validation.violation != schedule_violation_type::none && validation.violation != schedule_violation_type::unfinished
+              && validation.step_index == *illegal_step_index,
+            "the validator misses an illegal step", times_to_cross
+          );
+        } else {
+          expect(
+            (validation.violation == schedule_violation_type::none) == (state_index == end_state_index)
+              && validation.step_index == crosser_masks.size() && validation.total_time == total_time,
+            "the validator misjudges a legal walk", times_to_cross
+          );
+        }
+      }
+    }
+  }
+
+  //  solve_fixed and build_fixed_state_graph, the instantiations for each people count, agree with
+  //  build_state_graph and solve_shortest_path, which take the people count at run time
+  void check_fixed_people_count() {
+    instance_generator_type instances;
+    for (auto instance_index = 0; instance_index < instance_count; ++instance_index) {
+      auto const times_to_cross = instances.get_times(1, 11);
+      auto const states = build_state_graph(times_to_cross);
+      auto const fixed_states = build_fixed_state_graph(times_to_cross);
+      auto const optimum = solve_shortest_path(states).total_time;
+      auto const schedule = solve_fixed(times_to_cross);
+
+      expect_schedule(times_to_cross, schedule.state_reprs, schedule.total_time);
+      expect(schedule.total_time == optimum, "solve_fixed misses the optimum", times_to_cross);
+      expect(
+        fixed_states.size() == states.size() && solve_shortest_path(fixed_states).total_time == optimum,
+        "build_fixed_state_graph misses the optimum", times_to_cross
+      );
+    }
+  }
+
+  //  solution_store_type answers with the optimum of solve_fixed whether it solves, reads its file or
+  //  hits its cache, also for the same times in another order
+  void check_solution_store() {
+    auto const path = (std::filesystem::temp_directory_path() / "rope_bridge_cross_check_store").string();
+    std::filesystem::remove(path);
+
+    //  the second pass reopens the file of the first for the same instances
+    for (auto const cache_capacity : {std::size_t {1}, std::size_t {64}}) {
+      instance_generator_type instances;
+      auto store = solution_store_type::open(path, 256, cache_capacity);
+      for (auto instance_index = 0; instance_index < instance_count / 2; ++instance_index) {
+        auto times_to_cross = instances.get_times(1, 9, 20);
+        for (auto repeat_index = 0; repeat_index < 2; ++repeat_index) {
+          auto const schedule = store.solve(times_to_cross);
+          expect_schedule(times_to_cross, schedule.state_reprs, schedule.total_time);
+          expect(schedule.total_time == solve_fixed(times_to_cross).total_time, "the store misses the optimum", times_to_cross);
+          std::ranges::shuffle(times_to_cross, instances.generator);
+        }
+      }
+      expect(store.cache_hit_count > 0, "the store never hits its cache", {});
+      expect(cache_capacity == 1 || store.file_hit_count > 0, "the reopened store never reads its file", {});
+    }
+
+    std::filesystem::remove(path);
+  }
+
+  //  query_service_type answers solve and feasibility queries with the optimum of solve_fixed
+  void check_query_service() {
+    auto const service = query_service_type::preload({1, 2, 3, 4, 5, 6, 7, 8});
+    query_scratch_type scratch;
+    instance_generator_type instances;
+
+    for (auto instance_index = 0; instance_index < instance_count; ++instance_index) {
+      auto const times_to_cross = instances.get_times(1, 8);
+      auto const optimum = solve_fixed(times_to_cross).total_time;
+
+      //  requests without their word_count
+      std::vector<query_word_type> request {static_cast<query_word_type>(query_kind_type::solve)};
+      request.push_back(static_cast<query_word_type>(times_to_cross.size()));
+      request.insert(request.end(), times_to_cross.begin(), times_to_cross.end());
+      std::vector<query_word_type> response;
+      expect(service.answer(request, scratch, response) == query_status_type::ok, "a solve query fails", times_to_cross);
+      expect(response.at(2) == static_cast<query_word_type>(optimum), "a solve query misses the optimum", times_to_cross);
+      expect_schedule(times_to_cross, std::vector<query_word_type>(response.begin() + 4, response.end()), optimum);
+
+      request.front() = static_cast<query_word_type>(query_kind_type::feasibility);
+      for (auto const deadline : {optimum - 1, optimum}) {
+        request.push_back(static_cast<query_word_type>(deadline));
+        response.clear();
+        expect(service.answer(request, scratch, response) == query_status_type::ok, "a feasibility query fails", times_to_cross);
+        expect(
+          response.at(2) == (deadline >= optimum ? 1 : 0) && response.at(3) == static_cast<query_word_type>(optimum),
+          "a feasibility query misjudges the deadline", times_to_cross
+        );
+        request.pop_back();
+      }
+    }
+  }
+
+  //  a text instance file at path holding instance_times, one instance per line
+  void write_text_instances(std::string const &path, std::vector<std::vector<time_to_cross_type>> const &instance_times) {
+    std::ofstream output {path, std::ios::trunc};
+    for (auto const &times_to_cross : instance_times) {
+      output << format_times(times_to_cross) << '\n';
+    }
+  }
+
+  //  run_batch_pipeline writes the schedules of solve_fixed in input order, whatever order its solvers
+  //  finish the chunks in
+  void check_batch_pipeline() {
+    auto const path = (std::filesystem::temp_directory_path() / "rope_bridge_cross_check_pipeline").string();
+    instance_generator_type instances;
+    std::vector<std::vector<time_to_cross_type>> instance_times;
+    std::string expected_output;
+    for (auto instance_index = 0; instance_index < instance_count; ++instance_index) {
+      instance_times.push_back(instances.get_times(1, 10));
+      format_schedule(solve_fixed(instance_times.back()), expected_output);
+    }
+    write_text_instances(path, instance_times);
+
+    auto input = instance_stream_type::open(path);
+    std::string output;
+    run_batch_pipeline(
+      input,
+      [&](std::string_view const formatted) { output += formatted; },
+      {.solver_count = 3, .chunk_instance_count = 7, .chunk_count = 4, .metrics = nullptr}
+    );
+    std::filesystem::remove(path);
+
+    expect(output == expected_output, "the pipeline output differs from solve_fixed", {});
+  }
+
+  //  solve_delta_stepping and solve_batch_work_stealing on several workers take the optimum of
+  //  solve_fixed, for instances both grouped and split into delta-stepping rounds
+  void check_work_stealing() {
+    auto const path = (std::filesystem::temp_directory_path() / "rope_bridge_cross_check_stealing").string();
+    work_stealing_scheduler_type scheduler {3};
+    instance_generator_type instances;
+    std::vector<std::vector<time_to_cross_type>> instance_times;
+
+    for (auto instance_index = 0; instance_index < instance_count / 2; ++instance_index) {
+      auto const &times_to_cross = instance_times.emplace_back(instances.get_times(1, 12));
+      auto const schedule = solve_delta_stepping(times_to_cross, scheduler);
+      expect_schedule(times_to_cross, schedule.state_reprs, schedule.total_time);
+      expect(schedule.total_time == solve_fixed(times_to_cross).total_time, "delta-stepping misses the optimum", times_to_cross);
+    }
+
+    write_text_instances(path, instance_times);
+    auto const instance_file = instance_file_type::open(path);
+    auto const schedules = solve_batch_work_stealing(
+      instance_file,
+      scheduler,
+      {.min_split_people_count = 10, .group_cost = get_estimated_solve_cost(6), .metrics = nullptr}
+    );
+    std::filesystem::remove(path);
+
+    expect(schedules.size() == instance_times.size(), "work stealing loses instances", {});
+    for (std::size_t instance_index = 0; instance_index < schedules.size(); ++instance_index) {
+      auto const &times_to_cross = instance_times.at(instance_index);
+      auto const &schedule = schedules.at(instance_index);
+      expect_schedule(times_to_cross, schedule.state_reprs, schedule.total_time);
+      expect(schedule.total_time == solve_fixed(times_to_cross).total_time, "work stealing misses the optimum", times_to_cross);
+    }
+  }
+
+  //  solve_auto takes the optimum of solve_fixed with whichever engine a calibration makes fastest
+  void check_solve_auto() {
+    instance_generator_type instances;
+    auto const calibrations = std::vector<engine_calibration_type> {
+      {.implicit_ns_per_cost = 1, .materialized_ns_per_cost = 2, .delta_stepping_ns_per_cost = 3, .worker_count = 2},
+      {.implicit_ns_per_cost = 2, .materialized_ns_per_cost = 1, .delta_stepping_ns_per_cost = 3, .worker_count = 2},
+      {.implicit_ns_per_cost = 3, .materialized_ns_per_cost = 2, .delta_stepping_ns_per_cost = 1, .worker_count = 2}
+    };
+
+    for (auto instance_index = 0; instance_index < instance_count / 2; ++instance_index) {
+      auto const times_to_cross = instances.get_times(1, 10);
+      auto const optimum = solve_fixed(times_to_cross).total_time;
+      auto const &calibration = calibrations.at(static_cast<std::size_t>(instance_index) % calibrations.size());
+
+      for (auto const output : {solve_output_type::total_time, solve_output_type::schedule, solve_output_type::state_graph}) {
+        auto const solution = solve_auto(times_to_cross, output, std::uint64_t {1} << 30, calibration);
+        expect(
+          solution.total_time == optimum,
+          std::format("{} misses the optimum", get_solve_engine_name(solution.choice.engine)), times_to_cross
+        );
+        if (output != solve_output_type::total_time) {
+          expect_schedule(times_to_cross, solution.state_reprs, optimum);
+        }
+        if (output == solve_output_type::state_graph) {
+          expect(solution.states.size() == build_state_graph(times_to_cross).size(), "the state graph misses states", times_to_cross);
+        }
+      }
+    }
+  }
+
+  //  build_budgeted_state_graph solves to the optimum of solve_fixed in every representation, each
+  //  picked by a budget of just its estimate
+  void check_budgeted_state_graph() {
+    auto const external_path = (std::filesystem::temp_directory_path() / "rope_bridge_cross_check_graph").string();
+    instance_generator_type instances;
+
+    for (auto instance_index = 0; instance_index < instance_count / 4; ++instance_index) {
+      auto const times_to_cross = instances.get_times(1, 10);
+      auto const optimum = solve_fixed(times_to_cross).total_time;
+
+      for (auto const representation : {
+        state_graph_representation_type::adjacency_lists,
+        state_graph_representation_type::csr,
+        state_graph_representation_type::compact_csr,
+        state_graph_representation_type::external_csr,
+        state_graph_representation_type::implicit
+      }) {
+        std::filesystem::remove(external_path);
+        auto const graph = build_budgeted_state_graph(
+          times_to_cross,
+          {
+            .memory_bytes = get_estimated_representation_bytes(representation, times_to_cross.size()),
+            .external_path = external_path
+          }
+        );
+        auto const schedule = graph.solve();
+        expect_schedule(times_to_cross, schedule.state_reprs, schedule.total_time);
+        expect(
+          schedule.total_time == optimum,
+          std::format("{} misses the optimum", get_state_graph_representation_name(graph.plan.representation)),
+          times_to_cross
+        );
+      }
+    }
+
+    std::filesystem::remove(external_path);
+  }
+
+  //  stops a search by throwing on its pop_limit-th expansion
+  struct interrupting_observer_type : null_solver_observer_type {
+    void on_pop(int_value_type, auto, std::size_t) {
+      if (++pop_count == pop_limit) {
+        throw std::runtime_error("interrupted");
+      }
+    }
+
+    std::uint64_t pop_limit = 0;
+    std::uint64_t pop_count = 0;
+  };
+
+  //  solve_checkpointed takes the optimum of solve_fixed, also when resumed from a checkpoint of a run
+  //  stopped part way, and rejects a checkpoint for other times
+  void check_checkpointed() {
+    auto const path = (std::filesystem::temp_directory_path() / "rope_bridge_cross_check_checkpoint").string();
+    instance_generator_type instances;
+    checkpoint_options_type options {.path = path, .interval = std::chrono::nanoseconds {0}, .resume = false};
+
+    for (auto instance_index = 0; instance_index < instance_count / 20; ++instance_index) {
+      auto const times_to_cross = instances.get_times(12, 14);
+      auto const optimum = solve_fixed(times_to_cross).total_time;
+      std::filesystem::remove(path);
+
+      options.resume = false;
+      interrupting_observer_type observer;
+      observer.pop_limit = 5000 + instances.generator() % 10000;
+      try {
+        static_cast<void>(solve_checkpointed(times_to_cross, options, observer));
+      } catch (std::runtime_error const &) {
+      }
+      expect(std::filesystem::exists(path), "an interrupted run leaves no checkpoint", times_to_cross);
+
+      options.resume = true;
+      auto const schedule = solve_checkpointed(times_to_cross, options);
+      expect_schedule(times_to_cross, schedule.state_reprs, schedule.total_time);
+      expect(schedule.total_time == optimum, "a resumed run misses the optimum", times_to_cross);
+
+      auto other_times = times_to_cross;
+      ++other_times.front();
+      auto rejected = false;
+      try {
+        static_cast<void>(solve_checkpointed(other_times, options));
+      } catch (std::invalid_argument const &) {
+        rejected = true;
+      }
+      expect(rejected, "a checkpoint for other times is resumed", times_to_cross);
+    }
+
+    std::filesystem::remove(path);
+  }
+
+  //  solve_ida_star takes the optimum of solve_fixed
+  void check_ida_star() {
+    instance_generator_type instances;
+    for (auto instance_index = 0; instance_index < instance_count; ++instance_index) {
+      auto const times_to_cross = instances.get_times(1, 10, 30);
+      auto const schedule = solve_ida_star(times_to_cross);
+      expect_schedule(times_to_cross, schedule.state_reprs, schedule.total_time);
+      expect(schedule.total_time == solve_fixed(times_to_cross).total_time, "IDA* misses the optimum", times_to_cross);
+    }
+  }
+
+  //  solve_frontier_search takes the optimum of solve_fixed, with its path rebuilt from relays
+  void check_frontier_search() {
+    instance_generator_type instances;
+    for (auto instance_index = 0; instance_index < instance_count; ++instance_index) {
+      auto const times_to_cross = instances.get_times(1, 10, 30);
+      auto const schedule = solve_frontier_search(times_to_cross);
+      expect_schedule(times_to_cross, schedule.state_reprs, schedule.total_time);
+      expect(schedule.total_time == solve_fixed(times_to_cross).total_time, "frontier search misses the optimum", times_to_cross);
+    }
+  }
+
+  struct cross_check_type {
+    std::string_view name;
+    void (*run)();
+  };
+
+  auto const cross_checks = std::vector<cross_check_type> {
+    {.name = "release_times", .run = check_release_times},
+    {.name = "time_dependent", .run = check_time_dependent},
+    {.name = "stochastic", .run = check_stochastic},
+    {.name = "dynamic_optimum", .run = check_dynamic_optimum},
+    {.name = "extend_state_graph", .run = check_extend_state_graph},
+    {.name = "sensitivity", .run = check_sensitivity},
+    {.name = "optimum_curve", .run = check_optimum_curve},
+    {.name = "optimality_certificate", .run = check_optimality_certificate},
+    {.name = "schedule_validator", .run = check_schedule_validator},
+    {.name = "fixed_people_count", .run = check_fixed_people_count},
+    {.name = "solution_store", .run = check_solution_store},
+    {.name = "query_service", .run = check_query_service},
+    {.name = "batch_pipeline", .run = check_batch_pipeline},
+    {.name = "work_stealing", .run = check_work_stealing},
+    {.name = "solve_auto", .run = check_solve_auto},
+    {.name = "budgeted_state_graph", .run = check_budgeted_state_graph},
+    {.name = "checkpointed", .run = check_checkpointed},
+    {.name = "ida_star", .run = check_ida_star},
+    {.name = "frontier_search", .run = check_frontier_search}
+  };
+}
+
+int main(int const argc, char **const argv) {
+  std::span<char *const> const names {argv + 1, static_cast<std::size_t>(argc - 1)};
+  for (auto const *const name : names) {
+    if (std::ranges::none_of(cross_checks, [&](cross_check_type const &cross_check) { return cross_check.name == name; })) {
+      std::cerr << std::format("unknown check {}\n", name);
+      return 2;
+    }
+  }
+
+  auto failed = false;
+  for (auto const &cross_check : cross_checks) {
+    if (!names.empty() && std::ranges::none_of(names, [&](char const *const name) { return cross_check.name == name; })) {
+      continue;
+    }
+
+    try {
+      cross_check.run();
+      std::cout << std::format("{}: ok\n", cross_check.name);
+    } catch (std::exception const &error) {
+      std::cout << std::format("{}: failed. {}\n", cross_check.name, error.what());
+      failed = true;
+    }
+  }
+
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,243 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <queue>
+#include <stdexcept>
+#include <vector>
+
+#include "bridge_state.hpp"
+#include "memory_tracking.hpp"
+#include "solver_observer.hpp"
+#include "state_graph.hpp"
+#include "tracing.hpp"
+
+struct crossing_time_breakpoint_type {
+  time_to_cross_type departure_time;
+  time_to_cross_type time_to_cross;
+};
+
+//  every person's crossing time as a piecewise-linear function of the departure time. between two
+//  breakpoints the time is interpolated (rounded up), before the first and after the last it is
+//  constant. the functions must be FIFO: departing later never arrives earlier.
+//
+//  breakpoints of all people are stored back to back, person i owning
+//  [person_offsets[i], person_offsets[i + 1])
+struct time_dependent_times_to_cross_type {
+  static time_dependent_times_to_cross_type from_breakpoints(
+    std::vector<std::vector<crossing_time_breakpoint_type>> const &breakpoints_per_person
+  ) {
+    time_dependent_times_to_cross_type result;
+    result.person_offsets.reserve(breakpoints_per_person.size() + 1);
+    result.person_offsets.push_back(0);
+
+    for (std::size_t person_index = 0; person_index < breakpoints_per_person.size(); ++person_index) {
+      auto const &person_breakpoints = breakpoints_per_person.at(person_index);
+      validate_breakpoints(person_index, person_breakpoints);
+      result.breakpoints.insert(result.breakpoints.end(), person_breakpoints.begin(), person_breakpoints.end());
+      result.person_offsets.push_back(result.breakpoints.size());
+    }
+
+    return result;
+  }
+
+  static time_dependent_times_to_cross_type constant(std::vector<time_to_cross_type> const &times_to_cross) {
+    std::vector<std::vector<crossing_time_breakpoint_type>> breakpoints_per_person;
+    breakpoints_per_person.reserve(times_to_cross.size());
+    for (auto const time_to_cross : times_to_cross) {
+      breakpoints_per_person.push_back({{.departure_time = 0, .time_to_cross = time_to_cross}});
+    }
+
+    return from_breakpoints(breakpoints_per_person);
+  }
+
+  [[nodiscard]] std::size_t get_people_count() const {
+    return person_offsets.size() - 1;
+  }
+
+  [[nodiscard]] time_to_cross_type get_time_to_cross(
+    std::size_t const person_index,
+    time_to_cross_type const departure_time
+  ) const {
+    auto const first = breakpoints.begin() + person_offsets.at(person_index);
+    auto const last = breakpoints.begin() + person_offsets.at(person_index + 1);
+    auto const next = std::ranges::upper_bound(
+      first, last, departure_time, {}, &crossing_time_breakpoint_type::departure_time
+    );
+
+    if (next == first) {
+      return first->time_to_cross;
+    }
+
+    auto const prior = std::prev(next);
+    if (next == last) {
+      return prior->time_to_cross;
+    }
+
+    //  integer division truncates towards zero, which already rounds a negative slope up
+    auto const numerator = static_cast<std::int64_t>(next->time_to_cross - prior->time_to_cross)
+      * (departure_time - prior->departure_time);
+    auto const denominator = static_cast<std::int64_t>(next->departure_time - prior->departure_time);
+    auto const interpolated = numerator / denominator + (numerator % denominator > 0 ? 1 : 0);
+
+    return prior->time_to_cross + static_cast<time_to_cross_type>(interpolated);
+  }
+
+  std::vector<crossing_time_breakpoint_type> breakpoints;
+  std::vector<std::size_t> person_offsets;
+
+  private:
+  static void validate_breakpoints(
+    std::size_t const person_index,
+    std::vector<crossing_time_breakpoint_type> const &person_breakpoints
+  ) {
+    if (person_breakpoints.empty()) {
+      throw std::invalid_argument(std::format(
+        "breakpoint count of person {} is out of range. is 0. should be at least 1.",
+        person_index
+      ));
+    }
+
+    for (std::size_t breakpoint_index = 1; breakpoint_index < person_breakpoints.size(); ++breakpoint_index) {
+      auto const &prior = person_breakpoints.at(breakpoint_index - 1);
+      auto const &next = person_breakpoints.at(breakpoint_index);
+
+      if (next.departure_time <= prior.departure_time) {
+        throw std::invalid_argument(std::format(
+          "departure time of breakpoint {} of person {} is out of order. is {}. should be greater than {}.",
+          breakpoint_index, person_index, next.departure_time, prior.departure_time
+        ));
+      }
+      if (next.departure_time + next.time_to_cross < prior.departure_time + prior.time_to_cross) {
+        throw std::invalid_argument(std::format(
+          "arrival time of breakpoint {} of person {} is not FIFO. is {}. should be at least {}.",
+          breakpoint_index, person_index,
+          next.departure_time + next.time_to_cross, prior.departure_time + prior.time_to_cross
+        ));
+      }
+    }
+  }
+};
+
+struct time_dependent_crossing_type {
+  std::size_t state_index_after_crossing;
+  time_to_cross_type departure_time;
+  time_to_cross_type arrival_time;
+};
+
+struct time_dependent_schedule_type {
+  time_to_cross_type total_time;
+  std::vector<time_dependent_crossing_type> crossings;
+};
+
+//  earliest-arrival Dijkstra over a graph from build_state_graph, departing the start state at
+//  start_time. the static time_to_cross of each crossing is ignored; its crossers are recovered from
+//  the state_repr difference and their functions are evaluated when the crossing is relaxed. a
+//  crossing takes as long as its slowest crosser at that departure time, which keeps it FIFO, so the
+//  first time a state is popped its arrival time is final. observer is called as in
+//  solver_observer.hpp, with arrival times as distances.
+template <typename observer_type = null_solver_observer_type>
+time_dependent_schedule_type solve_time_dependent(
+  states_list_type const &states,
+  time_dependent_times_to_cross_type const &times_to_cross,
+  time_to_cross_type const start_time = 0,
+  observer_type &&observer = {}
+) {
+  ROPE_BRIDGE_TRACE_SPAN_ARG("solve_time_dependent", states.size());
+  if (
+    auto const people_count = states.at(start_state_index).get_people_count();
+    people_count != times_to_cross.get_people_count()
+  ) {
+    throw std::invalid_argument(std::format(
+      "times_to_cross people count is out of range. is {}. should be {}.",
+      times_to_cross.get_people_count(), people_count
+    ));
+  }
+
+  auto constexpr unreached = std::numeric_limits<time_to_cross_type>::max();
+  tracked_vector_type<time_to_cross_type, memory_category_type::solver_scratch> arrival_times(states.size(), unreached);
+  tracked_vector_type<std::size_t, memory_category_type::solver_scratch> predecessors(states.size(), start_state_index);
+
+  struct label_type {
+    time_to_cross_type time;
+    std::size_t state_index;
+
+    bool operator>(label_type const &other) const {
+      return time > other.time;
+    }
+  };
+  std::priority_queue<
+    label_type, tracked_vector_type<label_type, memory_category_type::solver_scratch>, std::greater<>
+  > frontier;
+
+  arrival_times.at(start_state_index) = start_time;
+  frontier.push({.time = start_time, .state_index = start_state_index});
+
+  while (!frontier.empty()) {
+    auto const label = frontier.top();
+    frontier.pop();
+
+    if (label.time > arrival_times.at(label.state_index)) {
+      continue;
+    }
+    auto const &curr_state = states.at(label.state_index);
+    if (label.state_index == end_state_index) {
+      observer.on_goal(curr_state.state_repr, label.time);
+      break;
+    }
+    observer.on_pop(curr_state.state_repr, label.time, frontier.size());
+
+    for (auto const &crossing : curr_state.possible_crossings) {
+      auto const &crossed_state = states.at(crossing.state_index_after_crossing);
+
+      time_to_cross_type time_to_cross = 0;
+      std::size_t crosser_index = 0;
+
+      for (
+        auto iterated_crossers = (curr_state.state_repr ^ crossed_state.state_repr) >> 1;
+        iterated_crossers != 0;
+        ++crosser_index, iterated_crossers >>= 1
+      ) {
+        if ((iterated_crossers & 1) == 0) {
+          continue;
+        }
+        time_to_cross = std::max(time_to_cross, times_to_cross.get_time_to_cross(crosser_index, label.time));
+      }
+
+      auto const arrival_time = label.time + time_to_cross;
+      observer.on_relax(curr_state.state_repr, crossed_state.state_repr, arrival_time);
+      if (arrival_time >= arrival_times.at(crossing.state_index_after_crossing)) {
+        continue;
+      }
+      observer.on_improve(curr_state.state_repr, crossed_state.state_repr, arrival_time);
+      arrival_times.at(crossing.state_index_after_crossing) = arrival_time;
+      predecessors.at(crossing.state_index_after_crossing) = label.state_index;
+      frontier.push({.time = arrival_time, .state_index = crossing.state_index_after_crossing});
+    }
+  }
+
+  time_dependent_schedule_type result {
+    .total_time = arrival_times.at(end_state_index) - start_time,
+    .crossings = {}
+  };
+
+  for (
+    auto state_index = end_state_index;
+    state_index != start_state_index;
+    state_index = predecessors.at(state_index)
+  ) {
+    result.crossings.push_back({
+      .state_index_after_crossing = state_index,
+      .departure_time = arrival_times.at(predecessors.at(state_index)),
+      .arrival_time = arrival_times.at(state_index)
+    });
+  }
+  std::ranges::reverse(result.crossings);
+
+  return result;
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+//  scoped spans recorded as Chrome trace events, for chrome://tracing or Perfetto.
+//
+//  ROPE_BRIDGE_TRACE_SPAN(name) and ROPE_BRIDGE_TRACE_SPAN_ARG(name, value) record the enclosing scope
+//  under the string literal name, the latter with an integer argument such as a people count. they
+//  expand to nothing unless ROPE_BRIDGE_TRACING is defined, which the CMake option of the same name
+//  does.
+//
+//  every thread records into its own ring buffer, which only that thread writes, so recording takes no
+//  lock and no atomic read-modify-write. a full buffer overwrites its oldest events. write_chrome_trace
+//  reads every buffer and is meant to run once the traced work has finished.
+
+#ifdef ROPE_BRIDGE_TRACING
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+struct trace_event_type {
+  char const *name;
+  std::int64_t start_ns;
+  std::int64_t duration_ns;
+  std::int64_t argument;
+  bool has_argument;
+};
+
+struct trace_buffer_type {
+  static auto constexpr capacity = std::size_t {1} << 16;
+
+  void record(trace_event_type const &event) {
+    auto const recorded_count = write_count.load(std::memory_order_relaxed);
+    events[recorded_count % capacity] = event;
+    write_count.store(recorded_count + 1, std::memory_order_release);
+  }
+
+  std::size_t thread_index;
+  std::atomic<std::size_t> write_count = 0;
+  std::array<trace_event_type, capacity> events;
+};
+
+//  owns the buffers of every thread that recorded, so they outlive their threads
+struct trace_registry_type {
+  static trace_registry_type &get() {
+    static trace_registry_type registry;
+    return registry;
+  }
+
+  trace_buffer_type &get_thread_buffer() {
+    thread_local trace_buffer_type *thread_buffer = nullptr;
+
+    if (thread_buffer == nullptr) {
+      std::scoped_lock const lock {buffers_mutex};
+      buffers.push_back(std::make_unique<trace_buffer_type>());
+      thread_buffer = buffers.back().get();
+      thread_buffer->thread_index = buffers.size();
+    }
+    return *thread_buffer;
+  }
+
+  [[nodiscard]] std::int64_t get_now_ns() const {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+  }
+
+  void write_chrome_trace(std::ostream &output) {
+    std::scoped_lock const lock {buffers_mutex};
+    output << "{\"traceEvents\":[";
+
+    auto first_event = true;
+    for (auto const &buffer : buffers) {
+      auto const recorded_count = buffer->write_count.load(std::memory_order_acquire);
+      auto const first_recorded = recorded_count > trace_buffer_type::capacity
+        ? recorded_count - trace_buffer_type::capacity
+        : 0;
+
+      for (auto recorded_index = first_recorded; recorded_index < recorded_count; ++recorded_index) {
+        auto const &event = buffer->events[recorded_index % trace_buffer_type::capacity];
+
+        output << (first_event ? "\n" : ",\n")
+          << "{\"name\":\"" << event.name
+          << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->thread_index
+          << ",\"ts\":" << event.start_ns / 1000 << '.' << event.start_ns / 100 % 10
+          << ",\"dur\":" << event.duration_ns / 1000 << '.' << event.duration_ns / 100 % 10;
+        if (event.has_argument) {
+          output << ",\"args\":{\"value\":" << event.argument << '}';
+        }
+        output << '}';
+        first_event = false;
+      }
+    }
+
+    output << "\n]}\n";
+  }
+
+  private:
+  trace_registry_type() = default;
+
+  std::chrono::steady_clock::time_point const epoch = std::chrono::steady_clock::now();
+  std::mutex buffers_mutex;
+  std::vector<std::unique_ptr<trace_buffer_type>> buffers;
+};
+
+struct trace_span_type {
+  explicit trace_span_type(char const *const name)
+    : name {name}, start_ns {trace_registry_type::get().get_now_ns()} {
+  }
+
+  trace_span_type(char const *const name, std::int64_t const argument)
+    : name {name}, start_ns {trace_registry_type::get().get_now_ns()}, argument {argument}, has_argument {true} {
+  }
+
+  trace_span_type(trace_span_type const &) = delete;
+  trace_span_type &operator=(trace_span_type const &) = delete;
+
+  ~trace_span_type() {
+    auto &registry = trace_registry_type::get();
+    registry.get_thread_buffer().record({
+      .name = name,
+      .start_ns = start_ns,
+      .duration_ns = registry.get_now_ns() - start_ns,
+      .argument = argument,
+      .has_argument = has_argument
+    });
+  }
+
+  private:
+  char const *name;
+  std::int64_t start_ns;
+  std::int64_t argument = 0;
+  bool has_argument = false;
+};
+
+#define ROPE_BRIDGE_TRACE_CONCAT_IMPL(prefix, line) prefix##line
+#define ROPE_BRIDGE_TRACE_CONCAT(prefix, line) ROPE_BRIDGE_TRACE_CONCAT_IMPL(prefix, line)
+#define ROPE_BRIDGE_TRACE_SPAN(name) \
+  trace_span_type const ROPE_BRIDGE_TRACE_CONCAT(trace_span_, __LINE__) {name}
+#define ROPE_BRIDGE_TRACE_SPAN_ARG(name, value) \
+  trace_span_type const ROPE_BRIDGE_TRACE_CONCAT(trace_span_, __LINE__) {name, static_cast<std::int64_t>(value)}
+
+#else
+
+#define ROPE_BRIDGE_TRACE_SPAN(name) static_cast<void>(0)
+#define ROPE_BRIDGE_TRACE_SPAN_ARG(name, value) static_cast<void>(0)
+
+#endif
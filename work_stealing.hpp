@@ -0,0 +1,204 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+//  a pool of workers that each own a deque of tasks. a worker runs its own tasks newest first and,
+//  once it has none, steals the oldest task of another worker, so uneven tasks even out without a
+//  static partition. tasks can fork with parallel_for, whose chunks land on the forking worker's deque
+//  for others to steal while the forking worker helps run them.
+struct work_stealing_scheduler_type {
+  using task_type = std::function<void()>;
+
+  explicit work_stealing_scheduler_type(std::size_t const worker_count) {
+    if (worker_count == 0) {
+      throw std::invalid_argument("worker_count is out of range. is 0. should be positive.");
+    }
+
+    for (std::size_t worker_index = 0; worker_index < worker_count; ++worker_index) {
+      queues.push_back(std::make_unique<worker_queue_type>());
+    }
+    for (std::size_t worker_index = 0; worker_index < worker_count; ++worker_index) {
+      workers.emplace_back([this, worker_index] {
+        run_worker(worker_index);
+      });
+    }
+  }
+
+  work_stealing_scheduler_type(work_stealing_scheduler_type const &) = delete;
+  work_stealing_scheduler_type &operator=(work_stealing_scheduler_type const &) = delete;
+
+  ~work_stealing_scheduler_type() {
+    stopping.store(true);
+    work_available.notify_all();
+    workers.clear();
+  }
+
+  [[nodiscard]] std::size_t get_worker_count() const {
+    return queues.size();
+  }
+
+  //  places task on the deque of worker_index, where it stays unless another worker steals it
+  void submit(std::size_t const worker_index, task_type &&task) {
+    pending_task_count.fetch_add(1);
+    {
+      auto &queue = *queues.at(worker_index);
+      std::scoped_lock const lock {queue.mutex};
+      queue.tasks.push_back(std::move(task));
+    }
+    work_available.notify_one();
+  }
+
+  //  waits until every submitted task has run, then rethrows the first exception a task threw
+  void wait_idle() {
+    {
+      std::unique_lock lock {idle_mutex};
+      idle.wait(lock, [&] { return pending_task_count.load() == 0; });
+    }
+
+    std::exception_ptr exception;
+    {
+      std::scoped_lock const lock {idle_mutex};
+      std::swap(exception, first_exception);
+    }
+    if (exception) {
+      std::rethrow_exception(exception);
+    }
+  }
+
+  //  runs body(chunk_index) for every chunk_index in [0, chunk_count) and returns once all have run.
+  //  from a worker of this scheduler the chunks are forked onto its deque; anywhere else they run inline.
+  template <typename body_type>
+  void parallel_for(std::size_t const chunk_count, body_type const &body) {
+    if (current_scheduler != this || chunk_count <= 1) {
+      for (std::size_t chunk_index = 0; chunk_index < chunk_count; ++chunk_index) {
+        body(chunk_index);
+      }
+      return;
+    }
+
+    auto const worker_index = current_worker_index;
+    std::atomic<std::size_t> remaining_chunk_count = chunk_count - 1;
+    std::exception_ptr chunk_exception;
+    std::mutex chunk_exception_mutex;
+
+    auto const run_chunk = [&](std::size_t const chunk_index) {
+      try {
+        body(chunk_index);
+      } catch (...) {
+        std::scoped_lock const lock {chunk_exception_mutex};
+        if (!chunk_exception) {
+          chunk_exception = std::current_exception();
+        }
+      }
+    };
+
+    for (auto chunk_index = chunk_count - 1; chunk_index > 0; --chunk_index) {
+      submit(worker_index, [&, chunk_index] {
+        run_chunk(chunk_index);
+        remaining_chunk_count.fetch_sub(1);
+      });
+    }
+
+    //  caught as the forked chunks are, so they are waited for before the locals they use go
+    run_chunk(0);
+
+    while (remaining_chunk_count.load() != 0) {
+      if (!try_run_one(worker_index)) {
+        std::this_thread::yield();
+      }
+    }
+
+    if (chunk_exception) {
+      std::rethrow_exception(chunk_exception);
+    }
+  }
+
+  private:
+  struct worker_queue_type {
+    std::mutex mutex;
+    std::deque<task_type> tasks;
+  };
+
+  static auto constexpr no_worker_index = static_cast<std::size_t>(-1);
+
+  void run_worker(std::size_t const worker_index) {
+    current_scheduler = this;
+    current_worker_index = worker_index;
+
+    while (!stopping.load()) {
+      if (try_run_one(worker_index)) {
+        continue;
+      }
+
+      std::unique_lock lock {idle_mutex};
+      work_available.wait_for(lock, std::chrono::milliseconds {1});
+    }
+  }
+
+  //  runs the newest task of worker_index or else the oldest task of another worker
+  bool try_run_one(std::size_t const worker_index) {
+    task_type task;
+
+    {
+      auto &queue = *queues.at(worker_index);
+      std::scoped_lock const lock {queue.mutex};
+      if (!queue.tasks.empty()) {
+        task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+      }
+    }
+
+    for (std::size_t offset = 1; !task && offset < queues.size(); ++offset) {
+      auto &queue = *queues.at((worker_index + offset) % queues.size());
+      std::scoped_lock const lock {queue.mutex};
+      if (!queue.tasks.empty()) {
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+      }
+    }
+
+    if (!task) {
+      return false;
+    }
+
+    try {
+      task();
+    } catch (...) {
+      std::scoped_lock const lock {idle_mutex};
+      if (!first_exception) {
+        first_exception = std::current_exception();
+      }
+    }
+
+    if (pending_task_count.fetch_sub(1) == 1) {
+      std::scoped_lock const lock {idle_mutex};
+      idle.notify_all();
+    }
+    return true;
+  }
+
+  inline static thread_local work_stealing_scheduler_type *current_scheduler = nullptr;
+  inline static thread_local std::size_t current_worker_index = no_worker_index;
+
+  std::vector<std::unique_ptr<worker_queue_type>> queues;
+  std::atomic<std::size_t> pending_task_count = 0;
+  std::atomic<bool> stopping = false;
+  std::mutex idle_mutex;
+  std::condition_variable idle;
+  std::condition_variable work_available;
+  std::exception_ptr first_exception;
+  //  last, so the workers stop before anything they use is destroyed
+  std::vector<std::jthread> workers;
+};
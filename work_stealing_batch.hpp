@@ -0,0 +1,234 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <numeric>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "bridge_state.hpp"
+#include "fixed_people_count.hpp"
+#include "instance_file.hpp"
+#include "memory_tracking.hpp"
+#include "solve_metrics.hpp"
+#include "tracing.hpp"
+#include "work_stealing.hpp"
+
+//  relative cost of solving people_count people: about 2^n states with up to n^2 / 2 crossings each
+inline std::uint64_t get_estimated_solve_cost(std::size_t const people_count) {
+  return std::uint64_t {people_count * people_count + 1} << people_count;
+}
+
+//  the optimal schedule by delta-stepping over the implicit graph, with the relaxations of every
+//  bucket round forked through scheduler.parallel_for so one large instance keeps every worker busy.
+//
+//  a label packs the distance above the predecessor's state_repr offset, so one atomic minimum keeps
+//  both consistent, and ties go to the smallest predecessor whatever the order of relaxations, which
+//  makes the schedule deterministic. buckets span delta = the fastest time, are processed in order and
+//  each is repeated until nothing in it improves, after which its distances are final.
+inline fixed_schedule_type solve_delta_stepping(
+  std::span<time_to_cross_type const> const times_to_cross,
+  work_stealing_scheduler_type &scheduler
+) {
+  using int_value_type = bridge_state_type::int_value_type;
+  using label_type = std::uint64_t;
+  ROPE_BRIDGE_TRACE_SPAN_ARG("solve_delta_stepping", times_to_cross.size());
+
+  auto const people_count = times_to_cross.size();
+  auto const leading_one = bridge_state_type::start(people_count).state_repr;
+  //  offsets from leading_one
+  auto const start_offset = int_value_type {0};
+  auto const end_offset = leading_one - 1;
+
+  auto const delta = std::max<std::uint64_t>(1, *std::ranges::min_element(times_to_cross));
+  auto constexpr unreached = std::numeric_limits<label_type>::max();
+  auto constexpr states_per_chunk = std::size_t {1} << 10;
+
+  auto const get_distance = [](label_type const label) {
+    return label >> 32;
+  };
+
+  tracked_vector_type<std::atomic<label_type>, memory_category_type::solver_scratch> labels(leading_one);
+  for (auto &label : labels) {
+    label.store(unreached, std::memory_order_relaxed);
+  }
+  labels[start_offset].store(0);
+
+  struct improved_state_type {
+    std::uint64_t bucket_index;
+    int_value_type state_offset;
+  };
+  std::map<std::uint64_t, std::vector<int_value_type>> buckets {{0, {start_offset}}};
+  std::vector<std::vector<improved_state_type>> improved_by_chunk;
+
+  while (!buckets.empty()) {
+    auto const bucket_index = buckets.begin()->first;
+    if (get_distance(labels[end_offset].load()) / delta < bucket_index) {
+      break;
+    }
+    auto frontier = std::move(buckets.begin()->second);
+    buckets.erase(buckets.begin());
+
+    while (!frontier.empty()) {
+      ROPE_BRIDGE_TRACE_SPAN_ARG("delta_stepping_round", frontier.size());
+      std::ranges::sort(frontier);
+      frontier.erase(std::ranges::unique(frontier).begin(), frontier.end());
+
+      auto const chunk_count = (frontier.size() + states_per_chunk - 1) / states_per_chunk;
+      improved_by_chunk.resize(chunk_count);
+
+      scheduler.parallel_for(chunk_count, [&](std::size_t const chunk_index) {
+        ROPE_BRIDGE_TRACE_SPAN_ARG("relax_frontier_chunk", chunk_index);
+        auto &improved = improved_by_chunk[chunk_index];
+        improved.clear();
+
+        auto const first = chunk_index * states_per_chunk;
+        auto const last = std::min(frontier.size(), first + states_per_chunk);
+
+        for (auto frontier_index = first; frontier_index < last; ++frontier_index) {
+          auto const state_offset = frontier[frontier_index];
+          auto const distance = get_distance(labels[state_offset].load(std::memory_order_relaxed));
+          if (distance / delta != bucket_index) {
+            continue;
+          }
+
+          auto const state_repr = state_offset + leading_one;
+          auto const relax = [&](int_value_type const crossed_state_repr, time_to_cross_type const time_to_cross) {
+            auto const crossed_distance = distance + static_cast<std::uint64_t>(time_to_cross);
+            auto const crossed_label = crossed_distance << 32 | state_offset;
+            auto &label = labels[crossed_state_repr - leading_one];
+
+            for (auto prior_label = label.load(std::memory_order_relaxed); crossed_label < prior_label;) {
+              if (label.compare_exchange_weak(prior_label, crossed_label, std::memory_order_relaxed)) {
+                improved.push_back({
+                  .bucket_index = crossed_distance / delta,
+                  .state_offset = crossed_state_repr - leading_one
+                });
+                break;
+              }
+            }
+          };
+
+          for_each_possible_crossing(state_repr, people_count, times_to_cross, relax);
+        }
+      });
+
+      frontier.clear();
+      for (std::size_t chunk_index = 0; chunk_index < chunk_count; ++chunk_index) {
+        for (auto const &improved : improved_by_chunk[chunk_index]) {
+          if (improved.bucket_index == bucket_index) {
+            frontier.push_back(improved.state_offset);
+          } else {
+            buckets[improved.bucket_index].push_back(improved.state_offset);
+          }
+        }
+      }
+    }
+  }
+
+  fixed_schedule_type result {
+    .total_time = static_cast<time_to_cross_type>(get_distance(labels[end_offset].load())),
+    .state_reprs = {end_offset + leading_one}
+  };
+  for (auto state_offset = end_offset; state_offset != start_offset;) {
+    state_offset = static_cast<int_value_type>(labels[state_offset].load() & 0xffff'ffff);
+    result.state_reprs.push_back(state_offset + leading_one);
+  }
+  std::ranges::reverse(result.state_reprs);
+
+  return result;
+}
+
+struct work_stealing_batch_options_type {
+  //  instances this large are split with solve_delta_stepping
+  std::size_t min_split_people_count;
+  //  smaller instances are grouped into tasks of about this estimated cost
+  std::uint64_t group_cost;
+  //  receives the solve latencies once per task, unless nullptr
+  solve_metrics_collector_type *metrics;
+};
+
+//  solves every instance of instances on scheduler, returning the schedules in instance order.
+//
+//  instances estimated below group_cost are grouped in input order until a group reaches it, larger
+//  ones become tasks of their own, and those of at least min_split_people_count people fork into
+//  delta-stepping rounds. the tasks are then placed largest first on the least loaded worker by
+//  estimated cost, and work stealing evens out whatever the estimates missed.
+inline std::vector<fixed_schedule_type> solve_batch_work_stealing(
+  instance_file_type const &instances,
+  work_stealing_scheduler_type &scheduler,
+  work_stealing_batch_options_type const &options
+) {
+  auto const instance_count = instances.get_instance_count();
+  std::vector<fixed_schedule_type> result(instance_count);
+  ROPE_BRIDGE_TRACE_SPAN_ARG("solve_batch_work_stealing", instance_count);
+
+  struct task_range_type {
+    std::size_t first_instance_index;
+    std::size_t last_instance_index;
+    std::uint64_t estimated_cost;
+  };
+  std::vector<task_range_type> task_ranges;
+
+  for (std::size_t instance_index = 0; instance_index < instance_count; ++instance_index) {
+    auto const estimated_cost = get_estimated_solve_cost(instances.get_instance(instance_index).size());
+    auto const groupable = estimated_cost < options.group_cost;
+
+    if (
+      groupable
+        && !task_ranges.empty()
+        && task_ranges.back().last_instance_index == instance_index
+        && task_ranges.back().estimated_cost < options.group_cost
+    ) {
+      ++task_ranges.back().last_instance_index;
+      task_ranges.back().estimated_cost += estimated_cost;
+      continue;
+    }
+
+    task_ranges.push_back({
+      .first_instance_index = instance_index,
+      .last_instance_index = instance_index + 1,
+      //  keeps a large instance from taking in the small ones after it
+      .estimated_cost = groupable ? estimated_cost : std::max(estimated_cost, options.group_cost)
+    });
+  }
+
+  std::ranges::sort(task_ranges, std::greater {}, &task_range_type::estimated_cost);
+  std::vector<std::uint64_t> worker_loads(scheduler.get_worker_count());
+
+  for (auto const &task_range : task_ranges) {
+    auto const worker_index = static_cast<std::size_t>(std::ranges::min_element(worker_loads) - worker_loads.begin());
+    worker_loads.at(worker_index) += task_range.estimated_cost;
+
+    scheduler.submit(worker_index, [&, task_range] {
+      ROPE_BRIDGE_TRACE_SPAN_ARG("batch_task", task_range.last_instance_index - task_range.first_instance_index);
+      solve_metrics_type task_metrics;
+
+      for (auto instance_index = task_range.first_instance_index; instance_index < task_range.last_instance_index; ++instance_index) {
+        auto const times_to_cross = instances.get_instance(instance_index);
+        auto const solve_start = options.metrics != nullptr
+          ? std::chrono::steady_clock::now()
+          : std::chrono::steady_clock::time_point {};
+        result.at(instance_index) = times_to_cross.size() >= options.min_split_people_count
+          ? solve_delta_stepping(times_to_cross, scheduler)
+          : solve_fixed(times_to_cross);
+        if (options.metrics != nullptr) {
+          task_metrics.record(times_to_cross.size(), get_elapsed_ns(solve_start));
+        }
+      }
+
+      if (options.metrics != nullptr) {
+        options.metrics->add(task_metrics);
+      }
+    });
+  }
+
+  scheduler.wait_idle();
+  return result;
+}